@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "graph.h"
+#include "graph_reduction.h"
+#include "result_writer.h"
+#include "solvers.h"
+#include "topology_generators.h"
+#include "vertex_order.h"
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// Benchmark driver: runs every solver on every synthetic topology and prints
+// one NDJSON record per (topology, algorithm) with the best wall time over
+// --repeat runs, peak RSS and the solver's operation counters. Exits with
+// status 1 if two solvers disagree on a max-flow value.
+
+// Keeps the head of the solver output (where maxFlow is) and drops the rest,
+// so formatting cost is still measured without holding the edge flows.
+struct HeadBuffer : streambuf
+{
+    string head;
+
+protected:
+    streamsize xsputn(const char *s, streamsize n) override
+    {
+        if (head.size() < 4096)
+            head.append(s, min<size_t>(n, 4096 - head.size()));
+        return n;
+    }
+    int overflow(int c) override
+    {
+        if (c != EOF && head.size() < 4096)
+            head.push_back((char)c);
+        return c;
+    }
+};
+
+struct RunResult
+{
+    bool ok = false;
+    double maxFlow = 0, seconds = 0;
+    long peakRssKb = -1;
+    SolverStats stats;
+};
+
+// Set by --reduce and --reorder: the preprocessing is timed together with
+// the solve.
+static bool reduceGraph = false, reorderGraph = false;
+static VertexOrder order;
+static string orderName;
+// Set by --shuffle: node ids of the generated graph are randomly permuted,
+// as real router numbering rarely follows the topology.
+static bool shuffleIds = false;
+
+static bool buildTopology(const string &topology, int size, unsigned seed, Graph &graph)
+{
+    if (!makeTopology(topology, size, seed, graph))
+        return false;
+    if (shuffleIds)
+    {
+        vector<int> id(graph.n);
+        for (int v = 0; v < graph.n; v++)
+            id[v] = v;
+        shuffle(id.begin(), id.end(), mt19937(seed));
+        graph = relabel(graph, id);
+    }
+    return true;
+}
+
+static RunResult runOnce(const string &algo, const Graph &graph)
+{
+    RunResult r;
+    HeadBuffer sink;
+    ostream os(&sink);
+    ResultWriter out(os);
+    auto t0 = chrono::steady_clock::now();
+    const Graph *input = &graph;
+    unique_ptr<GraphReduction> reduction;
+    if (reduceGraph)
+    {
+        reduction.reset(new GraphReduction(graph));
+        out.reduction = reduction.get();
+        input = &reduction->graph;
+    }
+    Graph relabeled;
+    if (reorderGraph)
+    {
+        relabeled = relabel(*input, vertexOrder(*input, order));
+        out.original = input;
+        input = &relabeled;
+    }
+    r.ok = runAlgorithm(algo, *input, out);
+    out.flush();
+    r.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    r.stats = out.stats;
+    size_t at = sink.head.find("\"maxFlow\":");
+    if (at == string::npos)
+        r.ok = false;
+    else
+        r.maxFlow = strtod(sink.head.c_str() + at + 10, nullptr);
+    return r;
+}
+
+#ifndef _WIN32
+// Each run happens in a forked child that also builds the graph, so its peak
+// RSS covers only this instance and not earlier, larger ones.
+static RunResult runIsolated(const string &algo, const string &topology, int size, unsigned seed)
+{
+    RunResult r;
+    int fd[2];
+    if (pipe(fd) != 0)
+        return r;
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        close(fd[0]);
+        Graph graph;
+        buildTopology(topology, size, seed, graph);
+        RunResult c = runOnce(algo, graph);
+        struct rusage ru;
+        getrusage(RUSAGE_SELF, &ru);
+        c.peakRssKb = ru.ru_maxrss;
+        ssize_t written = write(fd[1], &c, sizeof c);
+        _exit(written == (ssize_t)sizeof c ? 0 : 1);
+    }
+    close(fd[1]);
+    if (pid < 0 || read(fd[0], &r, sizeof r) != (ssize_t)sizeof r)
+        r.ok = false;
+    close(fd[0]);
+    if (pid > 0)
+        waitpid(pid, nullptr, 0);
+    return r;
+}
+#endif
+
+static void usage()
+{
+    cerr << "usage: flow_bench [--size N] [--repeat R] [--seed S] "
+            "[--topology name]... [--algo name]... [--reduce] "
+            "[--reorder bfs|rcm|degree] [--shuffle]\n";
+}
+
+int main(int argc, char *argv[])
+{
+    int size = 2000, repeat = 3;
+    unsigned seed = 1;
+    vector<string> topologies, algos;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--reduce")
+        {
+            reduceGraph = true;
+            continue;
+        }
+        if (arg == "--shuffle")
+        {
+            shuffleIds = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 2;
+        }
+        if (arg == "--size")
+            size = atoi(argv[++i]);
+        else if (arg == "--repeat")
+            repeat = max(1, atoi(argv[++i]));
+        else if (arg == "--seed")
+            seed = (unsigned)strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--topology")
+            topologies.push_back(argv[++i]);
+        else if (arg == "--algo")
+            algos.push_back(argv[++i]);
+        else if (arg == "--reorder" && parseVertexOrder(argv[i + 1], order))
+        {
+            reorderGraph = true;
+            orderName = argv[++i];
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (topologies.empty())
+        topologies = TOPOLOGY_NAMES;
+    if (algos.empty())
+        algos = algorithmNames();
+
+    ResultWriter out(cout, OutputFormat::NDJSON);
+    bool mismatch = false;
+    for (const string &topology : topologies)
+    {
+        Graph graph;
+        if (!buildTopology(topology, size, seed, graph))
+        {
+            cerr << "Unknown topology: " << topology << "\n";
+            return 2;
+        }
+        double reference = NAN;
+        for (const string &algo : algos)
+        {
+            // Reduction drops costs, so min-cost solvers are left out.
+            if (reduceGraph && algo.compare(0, 4, "mcmf") == 0)
+                continue;
+            RunResult best;
+            for (int rep = 0; rep < repeat; rep++)
+            {
+#ifdef _WIN32
+                RunResult r = runOnce(algo, graph);
+#else
+                RunResult r = runIsolated(algo, topology, size, seed);
+#endif
+                if (!r.ok)
+                {
+                    best = r;
+                    break;
+                }
+                if (rep == 0 || r.seconds < best.seconds)
+                    best.seconds = r.seconds;
+                best.ok = true;
+                best.maxFlow = r.maxFlow;
+                best.peakRssKb = max(best.peakRssKb, r.peakRssKb);
+                best.stats = r.stats;
+            }
+
+            out.begin(algo);
+            out.field("topology", topology.c_str());
+            out.field("n", graph.n);
+            out.field("m", graph.edges.size());
+            if (reduceGraph)
+            {
+                GraphReduction reduction(graph);
+                out.field("reducedN", reduction.graph.n);
+                out.field("reducedM", reduction.graph.edges.size());
+            }
+            if (reorderGraph)
+                out.field("order", orderName.c_str());
+            if (!best.ok)
+            {
+                out.field("error", "run failed");
+                out.end();
+                out.flush();
+                mismatch = true;
+                continue;
+            }
+            bool agrees = isnan(reference) || fabs(best.maxFlow - reference) <= 1e-6 * max(1.0, fabs(reference));
+            if (isnan(reference))
+                reference = best.maxFlow;
+            mismatch |= !agrees;
+            out.field("maxFlow", best.maxFlow);
+            if (!agrees)
+                out.field("error", "maxFlow mismatch");
+            out.field("seconds", best.seconds);
+            if (best.peakRssKb >= 0)
+                out.field("peakRssKb", best.peakRssKb);
+            out.statsFields(best.stats);
+            out.end();
+            out.flush();
+            cout.flush();
+        }
+    }
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,201 @@
+#include "topology_generators.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+using namespace std;
+
+const vector<string> TOPOLOGY_NAMES = {"random", "layered", "grid", "fattree", "leafspine", "chain"};
+
+static const Capacity HOST_LINK = 10, FABRIC_LINK = 40;
+
+static void addEdge(Graph &g, int u, int v, Capacity cap, long long cost)
+{
+    g.edges.emplace_back(u, v, cap);
+    g.costs.push_back(cost);
+}
+
+static void addLink(Graph &g, int u, int v, Capacity cap)
+{
+    addEdge(g, u, v, cap, 1);
+    addEdge(g, v, u, cap, 1);
+}
+
+Graph randomSparse(int n, int deg, unsigned seed)
+{
+    mt19937 rng(seed);
+    uniform_int_distribution<int> node(0, n - 1);
+    uniform_int_distribution<int> cap(1, 100), cost(1, 20);
+    Graph g;
+    g.n = n;
+    g.src = 0;
+    g.sink = n - 1;
+    for (long long i = 0; i < (long long)n * deg; i++)
+    {
+        int u = node(rng), v = node(rng);
+        if (u != v)
+            addEdge(g, u, v, cap(rng), cost(rng));
+    }
+    return g;
+}
+
+Graph layered(int layers, int width, int deg, unsigned seed)
+{
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pick(0, width - 1);
+    uniform_int_distribution<int> cap(1, 1000), cost(1, 20);
+    Graph g;
+    g.n = layers * width + 2;
+    g.src = layers * width;
+    g.sink = layers * width + 1;
+    auto id = [width](int layer, int i) { return layer * width + i; };
+    for (int i = 0; i < width; i++)
+    {
+        addEdge(g, g.src, id(0, i), 1000, 0);
+        addEdge(g, id(layers - 1, i), g.sink, 1000, 0);
+    }
+    for (int l = 0; l + 1 < layers; l++)
+        for (int i = 0; i < width; i++)
+        {
+            for (int d = 0; d < deg; d++)
+                addEdge(g, id(l, i), id(l + 1, pick(rng)), cap(rng), cost(rng));
+            // Backward edges keep BFS levels from matching the layers.
+            if (l > 0 && pick(rng) < max(1, width / 8))
+                addEdge(g, id(l, i), id(l - 1, pick(rng)), cap(rng), cost(rng));
+        }
+    return g;
+}
+
+Graph gridGraph(int rows, int cols, unsigned seed)
+{
+    mt19937 rng(seed);
+    uniform_int_distribution<int> cap(1, 100), cost(1, 20);
+    Graph g;
+    g.n = rows * cols + 2;
+    g.src = rows * cols;
+    g.sink = rows * cols + 1;
+    for (int r = 0; r < rows; r++)
+    {
+        addEdge(g, g.src, r * cols, 1000, 0);
+        addEdge(g, r * cols + cols - 1, g.sink, 1000, 0);
+        for (int c = 0; c < cols; c++)
+        {
+            int u = r * cols + c;
+            if (c + 1 < cols)
+            {
+                addEdge(g, u, u + 1, cap(rng), cost(rng));
+                addEdge(g, u + 1, u, cap(rng), cost(rng));
+            }
+            if (r + 1 < rows)
+            {
+                addEdge(g, u, u + cols, cap(rng), cost(rng));
+                addEdge(g, u + cols, u, cap(rng), cost(rng));
+            }
+        }
+    }
+    return g;
+}
+
+Graph fatTree(int k)
+{
+    int half = k / 2;
+    int core = half * half, perPod = k + half * half; // edge + agg switches, hosts
+    Graph g;
+    g.n = core + k * perPod + 2;
+    g.src = g.n - 2;
+    g.sink = g.n - 1;
+    for (int p = 0; p < k; p++)
+    {
+        int base = core + p * perPod;
+        int agg = base, edge = base + half, host = base + k;
+        for (int a = 0; a < half; a++)
+        {
+            for (int c = 0; c < half; c++)
+                addLink(g, agg + a, a * half + c, FABRIC_LINK);
+            for (int e = 0; e < half; e++)
+                addLink(g, agg + a, edge + e, FABRIC_LINK);
+        }
+        for (int e = 0; e < half; e++)
+            for (int h = 0; h < half; h++)
+            {
+                int v = host + e * half + h;
+                addLink(g, edge + e, v, HOST_LINK);
+                if (p < half)
+                    addEdge(g, g.src, v, HOST_LINK, 0);
+                else
+                    addEdge(g, v, g.sink, HOST_LINK, 0);
+            }
+    }
+    return g;
+}
+
+Graph leafSpine(int leaves, int spines, int hostsPerLeaf)
+{
+    Graph g;
+    g.n = spines + leaves * (1 + hostsPerLeaf) + 2;
+    g.src = g.n - 2;
+    g.sink = g.n - 1;
+    for (int l = 0; l < leaves; l++)
+    {
+        int leaf = spines + l * (1 + hostsPerLeaf);
+        for (int s = 0; s < spines; s++)
+            addLink(g, leaf, s, FABRIC_LINK);
+        for (int h = 1; h <= hostsPerLeaf; h++)
+        {
+            addLink(g, leaf, leaf + h, HOST_LINK);
+            if (l < leaves / 2)
+                addEdge(g, g.src, leaf + h, HOST_LINK, 0);
+            else
+                addEdge(g, leaf + h, g.sink, HOST_LINK, 0);
+        }
+    }
+    return g;
+}
+
+Graph longChain(int n, unsigned seed)
+{
+    mt19937 rng(seed);
+    uniform_int_distribution<int> cap(1, 1000000);
+    Graph g;
+    g.n = n;
+    g.src = 0;
+    g.sink = n - 1;
+    for (int i = 0; i + 1 < n; i++)
+        addEdge(g, i, i + 1, cap(rng), 1);
+    return g;
+}
+
+bool makeTopology(const string &name, int size, unsigned seed, Graph &graph)
+{
+    size = max(size, 16);
+    if (name == "random")
+        graph = randomSparse(size, 4, seed);
+    else if (name == "layered")
+    {
+        int width = max(2, (int)sqrt((double)size));
+        graph = layered(max(2, size / width), width, 3, seed);
+    }
+    else if (name == "grid")
+    {
+        int side = max(2, (int)sqrt((double)size));
+        graph = gridGraph(side, side, seed);
+    }
+    else if (name == "fattree")
+    {
+        // A k-ary fat-tree has 5k^2/4 switches and k^3/4 hosts.
+        int k = 2;
+        while (5 * (k + 2) * (k + 2) / 4 + (k + 2) * (k + 2) * (k + 2) / 4 <= size)
+            k += 2;
+        graph = fatTree(k);
+    }
+    else if (name == "leafspine")
+    {
+        int hosts = 16;
+        int leaves = max(2, size / (hosts + 1));
+        graph = leafSpine(leaves, max(2, leaves / 4), hosts);
+    }
+    else if (name == "chain")
+        graph = longChain(size, seed);
+    else
+        return false;
+    return true;
+}
@@ -0,0 +1,35 @@
+#ifndef TOPOLOGY_GENERATORS_H
+#define TOPOLOGY_GENERATORS_H
+
+#include "graph.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+// Synthetic instances for flow_bench. Every generator is deterministic in its
+// seed, so the same (topology, size, seed) always gives the same graph.
+
+// n nodes with about deg random out-edges each; src 0, sink n-1.
+Graph randomSparse(int n, int deg, unsigned seed);
+// AC-style layered network: src feeds the first layer, each node links to
+// deg random nodes of the next layer, plus a few backward edges.
+Graph layered(int layers, int width, int deg, unsigned seed);
+// rows x cols grid with links both ways between neighbours; a super source
+// feeds the left column and the right column drains into a super sink.
+Graph gridGraph(int rows, int cols, unsigned seed);
+// k-ary fat-tree (k even): hosts in the first half of the pods send to hosts
+// in the second half, so the max flow is the bisection bandwidth.
+Graph fatTree(int k);
+// Two-tier leaf-spine fabric, every leaf linked to every spine; the first
+// half of the leaves' hosts send to the other half.
+Graph leafSpine(int leaves, int spines, int hostsPerLeaf);
+// Path of n nodes with random capacities.
+Graph longChain(int n, unsigned seed);
+
+extern const vector<string> TOPOLOGY_NAMES;
+
+// Builds the named topology with roughly size nodes. Returns false if the
+// name is unknown.
+bool makeTopology(const string &name, int size, unsigned seed, Graph &graph);
+
+#endif // TOPOLOGY_GENERATORS_H
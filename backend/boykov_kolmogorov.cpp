@@ -1,172 +1,196 @@
 #include "boykov_kolmogorov.h"
+#include "residual_graph.h"
+#include "solver_stats.h"
 #include <iostream>
 #include <vector>
-#include <queue>
 #include <tuple>
-#include <sstream>
 #include <climits>
 using namespace std;
 
-void runBoykovKolmogorov(const Graph &graph)
+// Boykov-Kolmogorov with the refinements of Kolmogorov's reference code:
+// a FIFO of active nodes, search trees that survive augmentations, and
+// timestamp/distance labels so each origin check during adoption stops at
+// the first node already verified in the current round.
+struct BoykovKolmogorov
 {
-    int n = graph.n, s = graph.src, t = graph.sink;
-    // Build capacity and adjacency
-    vector<vector<int>> capacity(n, vector<int>(n, 0)), flow(n, vector<int>(n, 0));
-    vector<vector<int>> adj(n);
-    for (auto &e : graph.edges) {
-        int u,v,c; tie(u,v,c)=e;
-        capacity[u][v] += c;
-        adj[u].push_back(v);
-        adj[v].push_back(u);
-    }
+    // parent[] markers besides a real arc index.
+    static constexpr int NONE = -1, TERMINAL = -2, ORPHAN = -3;
 
+    ResidualGraph<Capacity> &g;
+    int s, t;
     // label:  1 = in S-tree; -1 = in T-tree; 0 = free
-    vector<int> label(n,0), parent(n,-1);
-    queue<int> active, orphans;
+    // parent: arc at the node pointing to its tree parent. Residual capacity
+    // runs parent->node in the S-tree and node->parent in the T-tree.
+    pmr::vector<int> label, parent, ts, dist, nextActive;
+    // Orphans of the current adoption phase, processed in order.
+    pmr::vector<int> orphans;
+    int activeFirst = -1, activeLast = -1, time = 0;
+    SolverStats stats;
 
-    // Initialize: add source and sink roots
-    label[s]=1;  active.push(s);
-    label[t]=-1; active.push(t);
+    BoykovKolmogorov(ResidualGraph<Capacity> &g, int s, int t)
+        : g(g), s(s), t(t), label(g.n, 0, g.memory()), parent(g.n, NONE, g.memory()),
+          ts(g.n, 0, g.memory()), dist(g.n, 0, g.memory()), nextActive(g.n, -1, g.memory()),
+          orphans(g.memory()) {}
 
-    auto findAugmentingEdge = [&]() -> pair<int,int> {
-        // Growth phase: find edge between trees
-        int u = active.front(); active.pop();
-        for (int v: adj[u]) {
-            if (capacity[u][v] - flow[u][v] <= 0) continue;
-            if (label[v] == 0) {
-                // Grow same tree
-                label[v] = label[u];
-                parent[v] = u;
-                active.push(v);
-            }
-            else if (label[v] == -label[u]) {
-                // Found augmenting path between u and v
-                return {u,v};
-            }
-        }
-        return {-1,-1};
-    };
+    // FIFO of active nodes; the last node links to itself.
+    void setActive(int i) {
+        if (nextActive[i] >= 0) return;
+        nextActive[i] = i;
+        if (activeLast >= 0) nextActive[activeLast] = i;
+        else activeFirst = i;
+        activeLast = i;
+    }
 
-    auto augment = [&](int u, int v) {
-        // Determine bottleneck along s->…->u->v->…->t
-        int bottleneck = INT_MAX, cur;
-        // u back to s
-        cur = u;
-        while (cur != s) {
-            int p = parent[cur];
-            bottleneck = min(bottleneck, capacity[p][cur] - flow[p][cur]);
-            cur = p;
-        }
-        // edge u->v
-        bottleneck = min(bottleneck, capacity[u][v] - flow[u][v]);
-        // v back to t
-        cur = v;
-        while (cur != t) {
-            int p = parent[cur];
-            // But when v is in T-tree, parent links go towards t via reverse edges
-            bottleneck = min(bottleneck, capacity[cur][p] - flow[cur][p]);
-            cur = p;
+    int nextActiveNode() {
+        while (activeFirst >= 0) {
+            int i = activeFirst;
+            activeFirst = nextActive[i] == i ? -1 : nextActive[i];
+            if (activeFirst < 0) activeLast = -1;
+            nextActive[i] = -1;
+            if (label[i] != 0) return i;
         }
-        // Augment
-        // u->v
-        flow[u][v] += bottleneck;
-        flow[v][u] -= bottleneck;
-        // s->...->u
-        cur = u;
-        while (cur != s) {
-            int p = parent[cur];
-            flow[p][cur] += bottleneck;
-            flow[cur][p] -= bottleneck;
-            if (capacity[p][cur] - flow[p][cur] == 0)
-                orphans.push(cur);
-            cur = p;
+        return -1;
+    }
+
+    // Arc a leaves node i; returns the same link oriented from S towards T.
+    int towardSink(int i, int a) const { return label[i] == 1 ? a : g.rev[a]; }
+
+    Capacity augment(int mid) {
+        // Determine bottleneck along s->…->x->y->…->t
+        Capacity bottleneck = g.cap[mid];
+        for (int k = g.tail(mid); parent[k] != TERMINAL; k = g.head[parent[k]])
+            bottleneck = min(bottleneck, g.cap[g.rev[parent[k]]]);
+        for (int k = g.head[mid]; parent[k] != TERMINAL; k = g.head[parent[k]])
+            bottleneck = min(bottleneck, g.cap[parent[k]]);
+        // Augment, orphaning nodes whose parent arc saturates
+        g.push(mid, bottleneck);
+        for (int k = g.tail(mid); parent[k] != TERMINAL;) {
+            int a = g.rev[parent[k]], next = g.head[parent[k]];
+            g.push(a, bottleneck);
+            if (g.cap[a] == 0) { parent[k] = ORPHAN; orphans.push_back(k); stats.orphans++; }
+            k = next;
         }
-        // v -> ... -> t (reverse direction)
-        cur = v;
-        while (cur != t) {
-            int p = parent[cur];
-            flow[cur][p] += bottleneck;
-            flow[p][cur] -= bottleneck;
-            if (capacity[cur][p] - flow[cur][p] == 0)
-                orphans.push(cur);
-            cur = p;
+        for (int k = g.head[mid]; parent[k] != TERMINAL;) {
+            int a = parent[k], next = g.head[a];
+            g.push(a, bottleneck);
+            if (g.cap[a] == 0) { parent[k] = ORPHAN; orphans.push_back(k); stats.orphans++; }
+            k = next;
         }
         return bottleneck;
-    };
+    }
 
-    auto adopt = [&]() {
-        // Adoption phase: re-assign or remove orphans
-        while (!orphans.empty()) {
-            int u = orphans.front(); orphans.pop();
+    // Distance from j to its root, or INT_MAX if j hangs off an orphan.
+    // Nodes verified in this round (ts == time) end the walk early, and the
+    // walked path is stamped so later checks stop there too.
+    int originDistance(int j) {
+        int d = 0, k = j;
+        while (true) {
+            if (ts[k] == time) { d += dist[k]; break; }
+            if (parent[k] == TERMINAL) { ts[k] = time; dist[k] = 0; break; }
+            if (parent[k] == ORPHAN) return INT_MAX;
+            d++;
+            k = g.head[parent[k]];
+        }
+        int dk = d;
+        for (k = j; ts[k] != time; k = g.head[parent[k]]) { ts[k] = time; dist[k] = dk--; }
+        return d;
+    }
 
-            int side = label[u];
-            bool found_new_parent = false;
-            // Search neighbors for same-tree connection with residual > 0
-            for (int v: adj[u]) {
-                if (label[v] != side) continue;
-                // For source-tree: need capacity[v][u] - flow[v][u] > 0
-                // For sink-tree: need capacity[u][v] - flow[u][v] > 0
-                bool ok = (side==1)
-                          ? (capacity[v][u] - flow[v][u] > 0)
-                          : (capacity[u][v] - flow[u][v] > 0);
-                if (!ok) {
-                    continue;
-                }
-                // Check v has a path to its root
-                int cur = v;
-                while (cur!=-1 && cur!= (side==1? s:t)) cur = parent[cur];
-                if (cur == (side==1? s:t)) {
-                    parent[u] = v;
-                    found_new_parent = true;
-                    break;
-                }
+    void processOrphan(int i) {
+        int side = label[i], best = NONE, bestDist = INT_MAX;
+        // Search neighbors for same-tree connection with residual > 0
+        for (int a = g.first[i]; a < g.first[i + 1]; a++) {
+            int j = g.head[a];
+            if (label[j] != side || g.cap[side == 1 ? g.rev[a] : a] <= 0) continue;
+            int d = originDistance(j);
+            if (d < bestDist) { bestDist = d; best = a; }
+        }
+        if (best != NONE) {
+            parent[i] = best;
+            ts[i] = time;
+            dist[i] = bestDist + 1;
+            stats.adoptions++;
+            return;
+        }
+        // Its children become orphans; neighbours that could re-grow into
+        // it become active again
+        for (int a = g.first[i]; a < g.first[i + 1]; a++) {
+            int j = g.head[a];
+            if (label[j] != side) continue;
+            if (g.cap[side == 1 ? g.rev[a] : a] > 0) setActive(j);
+            int p = parent[j];
+            if (p >= 0 && g.head[p] == i) { parent[j] = ORPHAN; orphans.push_back(j); stats.orphans++; }
+        }
+        label[i] = 0;
+        parent[i] = NONE;
+    }
+
+    Capacity maxFlow() {
+        if (s == t) return 0;
+        label[s] = 1;  parent[s] = TERMINAL; setActive(s);
+        label[t] = -1; parent[t] = TERMINAL; setActive(t);
+        Capacity total = 0;
+        int i = -1;
+        while (true) {
+            // Keep growing from the same node after an augmentation
+            if (i < 0 || label[i] == 0) {
+                i = nextActiveNode();
+                if (i < 0) break;
             }
-            if (!found_new_parent) {
-                // Remove u from tree
-                label[u] = 0;
-                // Its children become orphans
-                for (int v: adj[u]) {
-                    if (parent[v]==u) orphans.push(v);
+            // Growth phase: find an arc between the trees, oriented S -> T
+            int mid = NONE;
+            for (int a = g.first[i]; a < g.first[i + 1]; a++) {
+                int j = g.head[a];
+                if (g.cap[towardSink(i, a)] <= 0) continue;
+                if (label[j] == 0) {
+                    label[j] = label[i];
+                    parent[j] = g.rev[a];
+                    ts[j] = ts[i];
+                    dist[j] = dist[i] + 1;
+                    setActive(j);
+                }
+                else if (label[j] != label[i]) { mid = towardSink(i, a); break; }
+                else if (ts[j] <= ts[i] && dist[j] > dist[i]) {
+                    // Shorten j's path to the root through i
+                    parent[j] = g.rev[a];
+                    ts[j] = ts[i];
+                    dist[j] = dist[i] + 1;
                 }
-                parent[u] = -1;
             }
+            if (mid == NONE) { i = -1; continue; }
+            time++;
+            total += augment(mid);
+            stats.augmentations++;
+            // Adoption phase: re-attach or free the orphans
+            for (size_t k = 0; k < orphans.size(); k++)
+                processOrphan(orphans[k]);
+            orphans.clear();
         }
-    };
-
-    int max_flow = 0;
-    
-    while (!active.empty()) {
-        pair<int, int> result = findAugmentingEdge();
-        int u = result.first;
-        int v = result.second;
-        if (u < 0) {
-            continue; // growth continues
-        }
-        // augment
-        max_flow += augment(u,v);
-        // adoption
-        adopt();
+        return total;
     }
+};
+
+void runBoykovKolmogorov(const Graph &graph, ResultWriter &out)
+{
+    StageTimer timer;
+    ResidualGraph<Capacity> rg(graph, out.memory());
+    BoykovKolmogorov bk(rg, graph.src, graph.sink);
+    out.stats.buildSeconds += timer.lap();
+    Capacity max_flow = bk.maxFlow();
+    out.stats.solveSeconds += timer.lap();
+    out.stats += bk.stats;
 
     // JSON Output
-    stringstream ss;
-    ss << "{";
-    ss << "\"algorithm\":\"Boykov-Kolmogorov Algorithm \",";
-    ss << "\"maxFlow\":" << max_flow << ",";
-    ss << "\"edgeFlows\":[";
-    bool first=true;
-    for (auto &e: graph.edges) {
-        int u,v,c; tie(u,v,c)=e;
-        int f = flow[u][v];
-        if (!first) ss << ",";
-        ss << "{\"u\":"<<u<<",\"v\":"<<v<<",\"cap\":"<<c<<",\"flow\":"<<f<<"}";
-        first=false;
-    }
-    ss << "]}";
-    cout << ss.str();
+    out.begin("Boykov-Kolmogorov Algorithm ");
+    out.field("maxFlow", max_flow);
+    out.cutEdges(rg, graph.src, graph.sink);
+    out.edgeFlows(graph, rg);
+    out.end();
 }
 
 /*
-TC Analysis (practical): roughly O(E * max_flow) with tree reuse optimizations.
-SC Analysis: O(V + E) for trees + O(V) for queues.
+TC Analysis (practical): O(V * E^2 * |C|) worst case, near-linear on the
+grid-like graphs it targets since trees are reused and each origin check
+stops at the first node stamped in the current round.
+SC Analysis: O(V + E) for trees, labels and the active FIFO.
 */
@@ -2,8 +2,9 @@
 #define BOYKOV_KOLMOGOROV_H
 
 #include "graph.h"
+#include "result_writer.h"
 
 // Runs the full Boykov–Kolmogorov max‐flow algorithm.
-void runBoykovKolmogorov(const Graph &graph);
+void runBoykovKolmogorov(const Graph &graph, ResultWriter &out);
 
 #endif // BOYKOV_KOLMOGOROV_H
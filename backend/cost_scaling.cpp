@@ -0,0 +1,290 @@
+#include "cost_scaling.h"
+#include "residual_graph.h"
+#include "dinic.h"
+#include "solver_stats.h"
+#include <climits>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+// Scaling factor for epsilon between refine passes.
+static const long long ALPHA = 16;
+
+// Turns a feasible flow into a min-cost one by cancelling negative cycles in
+// the residual graph with epsilon-scaling push-relabel (a min-cost
+// circulation), so the s-t flow value is left unchanged.
+struct CostScaling
+{
+    ResidualGraph<Capacity> &g;
+    int n;
+    pmr::vector<long long> cost, price;
+    pmr::vector<Capacity> excess;
+    pmr::vector<int> current;
+    // Ring of active nodes for refine(). A node is queued when its excess
+    // turns positive and discharged completely, so n slots suffice.
+    pmr::vector<int> active;
+    // Price update state: distances in steps of eps and the Dijkstra heap.
+    typedef pair<long long, int> Item;
+    pmr::vector<long long> rank;
+    pmr::vector<Item> heap;
+    long long work = 0, workLimit;
+    SolverStats stats;
+
+    CostScaling(ResidualGraph<Capacity> &g, const Graph &graph)
+        : g(g), n(g.n), cost(g.arcCount(), 0, g.memory()), price(n, 0, g.memory()),
+          excess(n, 0, g.memory()), current(n, 0, g.memory()), active(n, 0, g.memory()),
+          rank(n, 0, g.memory()), heap(g.memory())
+    {
+        // Price update once the relabel work reaches ~2 * (6n + m), as in
+        // Goldberg-Tarjan's global relabel.
+        workLimit = 12LL * n + 2LL * g.arcCount();
+        // Costs are scaled by n + 1 so that 1-optimal in scaled units means
+        // optimal in the original ones.
+        for (size_t i = 0; i < g.edgeArc.size(); i++)
+        {
+            int a = g.edgeArc[i];
+            cost[a] = graph.edgeCost(i) * (n + 1);
+            cost[g.rev[a]] = -cost[a];
+        }
+    }
+
+    long long reducedCost(int u, int a) const
+    {
+        return cost[a] + price[u] - price[g.head[a]];
+    }
+
+    // Global price update, the cost-scaling analogue of a global relabel: a
+    // Dijkstra backwards from the nodes with a deficit, where a residual arc
+    // u->v is floor(c_p / eps) + 1 steps long. Lowering each price by its
+    // distance times eps keeps the flow eps-optimal and turns every
+    // shortest-path arc admissible, so excess runs straight to a deficit
+    // instead of climbing there one eps-relabel at a time. The search stops
+    // once every node with excess is settled; the rest move down with the
+    // last distance settled, which keeps their arcs eps-optimal too.
+    void priceUpdate(long long eps)
+    {
+        fill(rank.begin(), rank.end(), LLONG_MAX);
+        heap.clear();
+        int remaining = 0;
+        for (int v = 0; v < n; v++)
+        {
+            if (excess[v] < 0)
+            {
+                rank[v] = 0;
+                heap.push_back({0, v});
+            }
+            else if (excess[v] > 0)
+            {
+                remaining++;
+            }
+        }
+        make_heap(heap.begin(), heap.end(), greater<Item>());
+        long long settled = 0;
+        while (!heap.empty() && remaining > 0)
+        {
+            pop_heap(heap.begin(), heap.end(), greater<Item>());
+            Item top = heap.back();
+            heap.pop_back();
+            int v = top.second;
+            if (top.first > rank[v])
+                continue;
+            settled = top.first;
+            if (excess[v] > 0)
+                remaining--;
+            for (int b = g.first[v]; b < g.first[v + 1]; b++)
+            {
+                int u = g.head[b], a = g.rev[b];
+                if (g.cap[a] <= 0)
+                    continue;
+                // Reduced costs are at least -eps, which is 0 steps.
+                long long rc = reducedCost(u, a);
+                long long d = rank[v] + (rc >= 0 ? rc / eps + 1 : 0);
+                if (d < rank[u])
+                {
+                    rank[u] = d;
+                    heap.push_back({d, u});
+                    push_heap(heap.begin(), heap.end(), greater<Item>());
+                }
+            }
+        }
+        for (int v = 0; v < n; v++)
+        {
+            price[v] -= min(rank[v], settled) * eps;
+            current[v] = g.first[v];
+        }
+        work = 0;
+        stats.globalRelabels++;
+    }
+
+    void refine(long long eps)
+    {
+        stats.phases++;
+        // Saturating every arc with reduced cost below -eps makes the flow
+        // eps-optimal but leaves excesses and deficits behind. Arcs within
+        // eps are left alone, so flow that is already good enough stays.
+        for (int u = 0; u < n; u++)
+        {
+            for (int a = g.first[u]; a < g.first[u + 1]; a++)
+            {
+                if (g.cap[a] > 0 && reducedCost(u, a) < -eps)
+                {
+                    Capacity f = g.cap[a];
+                    g.push(a, f);
+                    excess[u] -= f;
+                    excess[g.head[a]] += f;
+                }
+            }
+        }
+        int head = 0, size = 0;
+        for (int u = 0; u < n; u++)
+        {
+            if (excess[u] > 0)
+                active[size++] = u;
+        }
+        if (size > 0)
+            priceUpdate(eps);
+        while (size > 0)
+        {
+            int u = active[head];
+            head = (head + 1) % n;
+            size--;
+            while (excess[u] > 0)
+            {
+                int &a = current[u];
+                if (a == g.first[u + 1])
+                {
+                    // Relabel: the cheapest residual arc becomes admissible
+                    // with reduced cost -eps.
+                    long long best = LLONG_MIN;
+                    for (int b = g.first[u]; b < g.first[u + 1]; b++)
+                    {
+                        if (g.cap[b] > 0)
+                            best = max(best, price[g.head[b]] - cost[b]);
+                    }
+                    price[u] = best - eps;
+                    a = g.first[u];
+                    stats.relabels++;
+                    work += 12 + g.first[u + 1] - g.first[u];
+                    continue;
+                }
+                int v = g.head[a];
+                if (g.cap[a] > 0 && reducedCost(u, a) < 0)
+                {
+                    Capacity f = min(excess[u], g.cap[a]);
+                    if (excess[v] <= 0 && excess[v] + f > 0)
+                        active[(head + size++) % n] = v;
+                    stats.pushes++;
+                    g.push(a, f);
+                    excess[u] -= f;
+                    excess[v] += f;
+                }
+                else
+                {
+                    a++;
+                }
+            }
+            if (work > workLimit)
+                priceUpdate(eps);
+        }
+    }
+
+    // Starts prices at shortest-path distances from the source over the
+    // input edges, which is what potentials end up near anyway: flow on
+    // shortest paths then has reduced cost 0 and survives every refine, and
+    // only flow off them is rerouted. Dijkstra needs costs of at least 0;
+    // with negative ones prices start at 0 instead.
+    void initPrices(int s)
+    {
+        for (size_t i = 0; i < g.edgeArc.size(); i++)
+        {
+            if (cost[g.edgeArc[i]] < 0)
+                return;
+        }
+        fill(rank.begin(), rank.end(), LLONG_MAX);
+        heap.clear();
+        rank[s] = 0;
+        heap.push_back({0, s});
+        long long farthest = 0;
+        while (!heap.empty())
+        {
+            pop_heap(heap.begin(), heap.end(), greater<Item>());
+            Item top = heap.back();
+            heap.pop_back();
+            int u = top.second;
+            if (top.first > rank[u])
+                continue;
+            farthest = top.first;
+            for (int a = g.first[u]; a < g.first[u + 1]; a++)
+            {
+                int v = g.head[a];
+                if (g.orig[a] <= 0)
+                    continue;
+                long long d = rank[u] + cost[a];
+                if (d < rank[v])
+                {
+                    rank[v] = d;
+                    heap.push_back({d, v});
+                    push_heap(heap.begin(), heap.end(), greater<Item>());
+                }
+            }
+        }
+        // No input edge leads from a reached node to an unreached one, and
+        // edges the other way keep a non-negative reduced cost.
+        for (int v = 0; v < n; v++)
+            price[v] = min(rank[v], farthest);
+    }
+
+    void solve(int s)
+    {
+        initPrices(s);
+        long long eps = 1;
+        for (long long c : cost)
+            eps = max(eps, c);
+        do
+        {
+            eps = max(1LL, eps / ALPHA);
+            refine(eps);
+        } while (eps > 1);
+    }
+};
+
+void runCostScaling(const Graph &graph, ResultWriter &out)
+{
+    StageTimer timer;
+    ResidualGraph<Capacity> rg(graph, out.memory());
+    out.stats.buildSeconds += timer.lap();
+    Capacity flow = 0;
+    long long totalCost = 0;
+    if (graph.src != graph.sink)
+    {
+        // Any maximum flow is a feasible start; cost scaling then only
+        // reroutes it.
+        Dinic<Capacity> dinic(rg);
+        flow = dinic.maxFlow(graph.src, graph.sink);
+        CostScaling cs(rg, graph);
+        cs.solve(graph.src);
+        out.stats += dinic.stats;
+        out.stats += cs.stats;
+        for (size_t i = 0; i < graph.edges.size(); i++)
+            totalCost += rg.edgeFlow(i) * graph.edgeCost(i);
+    }
+    out.stats.solveSeconds += timer.lap();
+
+    // Stream JSON output.
+    out.begin("Cost-Scaling Min-Cost Max-Flow Algorithm");
+    out.field("maxFlow", flow);
+    out.field("cost", totalCost);
+    out.cutEdges(rg, graph.src, graph.sink);
+    out.edgeFlows(graph, rg);
+    out.end();
+}
+
+/*
+TC Analysis:
+  - O(V^2 * E * log(V * C)) with FIFO refine, where C is the largest cost;
+    independent of the capacities and of the total flow.
+  - Each price update is one O(E log V) Dijkstra, run once per O(V + E)
+    of relabel work, so it adds at most a log factor to that work.
+SC Analysis:
+  - O(V + E)
+*/
@@ -0,0 +1,12 @@
+#ifndef COST_SCALING_H
+#define COST_SCALING_H
+
+#include "graph.h"
+#include "result_writer.h"
+using namespace std;
+
+// Min-cost max-flow by Goldberg-Tarjan cost scaling. Same result as runMCMF,
+// but the running time does not depend on the capacities.
+void runCostScaling(const Graph &graph, ResultWriter &out);
+
+#endif // COST_SCALING_H
@@ -1,148 +1,196 @@
 #include "dinic.h"
-#include <queue>
-#include <climits>
 #include <vector>
-#include <sstream>
+#include <algorithm>
 using namespace std;
 
-struct DEdge
+template <typename Cap>
+Dinic<Cap>::Dinic(ResidualGraph<Cap> &g, DinicLabels labels)
+    : g(g), labels(labels), level(g.n, -1, g.memory()), start(g.n, 0, g.memory()),
+      path(g.memory()), bfsQueue(g.n, 0, g.memory())
 {
-    int v, cap, flow, rev;
-};
+}
 
-struct Dinic
+template <typename Cap>
+bool Dinic<Cap>::bfs(int s, int t)
 {
-    int V;
-    vector<vector<DEdge>> adj;
-    vector<int> level, start;
-
-    Dinic(int V) : V(V)
-    {
-        adj.resize(V);
-        level.assign(V, -1);
-        start.assign(V, 0);
-    }
+    for (int i = 0; i < reached; i++)
+        level[bfsQueue[i]] = -1;
+    return labels == DinicLabels::Reverse ? reverseBfs(s, t) : forwardBfs(s, t);
+}
 
-    void addEdge(int u, int v, int cap)
+template <typename Cap>
+bool Dinic<Cap>::forwardBfs(int s, int t)
+{
+    level[s] = 0;
+    int *q = bfsQueue.data();
+    int qh = 0, qt = 0;
+    q[qt++] = s;
+    // Once t is labelled, nothing past its layer can be on a shortest path:
+    // stop when the queue reaches that layer.
+    while (qh < qt && (level[t] < 0 || level[q[qh]] < level[t]))
     {
-        DEdge a{v, cap, 0, (int)adj[v].size()};
-        DEdge b{u, 0, 0, (int)adj[u].size()};
-        adj[u].push_back(a);
-        adj[v].push_back(b);
+        int u = q[qh++];
+        stats.arcScans += g.first[u + 1] - g.first[u];
+        for (int a = g.first[u]; a < g.first[u + 1]; a++)
+        {
+            int v = g.head[a];
+            if (level[v] < 0 && g.cap[a] > 0)
+            {
+                level[v] = level[u] + 1;
+                q[qt++] = v;
+            }
+        }
     }
+    reached = qt;
+    // The rest of t's layer leads nowhere; unlabel it so the blocking flow
+    // does not try it.
+    for (int i = qh; i < qt; i++)
+        if (q[i] != t)
+            level[q[i]] = -1;
+    return level[t] >= 0;
+}
 
-    bool bfs(int s, int t)
+// Finds each node's distance to t by following the residual arcs into it
+// backwards, stopping as soon as s is labelled, then flips the distances
+// into levels counted from s.
+template <typename Cap>
+bool Dinic<Cap>::reverseBfs(int s, int t)
+{
+    level[t] = 0;
+    int *q = bfsQueue.data();
+    int qh = 0, qt = 0;
+    q[qt++] = t;
+    while (qh < qt && level[s] < 0)
     {
-        fill(level.begin(), level.end(), -1);
-        level[s] = 0;
-        queue<int> q;
-        q.push(s);
-        while (!q.empty())
+        int v = q[qh++];
+        stats.arcScans += g.first[v + 1] - g.first[v];
+        for (int b = g.first[v]; b < g.first[v + 1]; b++)
         {
-            int u = q.front();
-            q.pop();
-            for (auto &e : adj[u])
+            int u = g.head[b];
+            if (level[u] < 0 && g.cap[g.rev[b]] > 0)
             {
-                if (level[e.v] < 0 && e.flow < e.cap)
-                {
-                    level[e.v] = level[u] + 1;
-                    q.push(e.v);
-                }
+                level[u] = level[v] + 1;
+                q[qt++] = u;
+                if (u == s)
+                    break;
             }
         }
-        return level[t] >= 0;
     }
+    reached = qt;
+    if (level[s] < 0)
+        return false;
+    // Nodes as far from t as s are not on any shortest path from it.
+    int depth = level[s];
+    for (int i = 0; i < qt; i++)
+    {
+        int v = q[i];
+        level[v] = level[v] == depth && v != s ? -1 : depth - level[v];
+    }
+    return true;
+}
 
-    int sendFlow(int u, int t, int flow)
+// Saturates the level graph with an explicit-stack DFS. path holds the arcs
+// from s to the current node; after each augmentation the search retreats
+// only to the first saturated arc, so one pass sends many paths without
+// restarting from s or recursing once per level.
+template <typename Cap>
+Cap Dinic<Cap>::blockingFlow(int s, int t, Cap limit)
+{
+    Cap total = 0;
+    path.clear();
+    int u = s;
+    while (total < limit)
     {
         if (u == t)
-            return flow;
-        for (int &i = start[u]; i < adj[u].size(); i++)
         {
-            DEdge &e = adj[u][i];
-            if (level[e.v] == level[u] + 1 && e.flow < e.cap)
+            Cap flow = limit - total;
+            for (int a : path)
+                flow = min(flow, g.cap[a]);
+            size_t cut = path.size();
+            for (size_t i = 0; i < path.size(); i++)
             {
-                int curr_flow = min(flow, e.cap - e.flow);
-                int temp_flow = sendFlow(e.v, t, curr_flow);
-                if (temp_flow > 0)
-                {
-                    e.flow += temp_flow;
-                    adj[e.v][e.rev].flow -= temp_flow;
-                    return temp_flow;
-                }
+                g.push(path[i], flow);
+                if (cut == path.size() && g.cap[path[i]] == 0)
+                    cut = i;
             }
+            total += flow;
+            stats.augmentations++;
+            path.resize(cut);
+            u = cut == 0 ? s : g.head[path.back()];
+            continue;
         }
-        return 0;
-    }
-
-    int maxFlow(int s, int t)
-    {
-        if (s == t)
-            return -1;
-        int total = 0;
-        while (bfs(s, t))
+        // Advance along the current arc if it is admissible.
+        int &a = start[u];
+        while (a < g.first[u + 1] && !(g.cap[a] > 0 && level[g.head[a]] == level[u] + 1))
+            a++;
+        if (a < g.first[u + 1])
         {
-            fill(start.begin(), start.end(), 0);
-            while (int flow = sendFlow(s, t, INT_MAX))
-                total += flow;
+            path.push_back(a);
+            u = g.head[a];
+            continue;
         }
-        return total;
+        // Dead end: retreat and skip the arc that led here.
+        if (u == s)
+            break;
+        level[u] = -1;
+        path.pop_back();
+        u = path.empty() ? s : g.head[path.back()];
+        start[u]++;
     }
-};
+    return total;
+}
 
-void runDinic(const Graph &graph)
+template <typename Cap>
+Cap Dinic<Cap>::maxFlow(int s, int t, Cap limit)
 {
-    int n = graph.n;
-    int s = graph.src, t = graph.sink;
-    Dinic dinic(n);
-    // Save original edges to report flows later.
-    vector<tuple<int, int, int>> originalEdges = graph.edges;
-    for (auto &edge : graph.edges)
+    if (s == t)
+        return -1;
+    Cap total = 0;
+    while (total < limit && bfs(s, t))
     {
-        int u, v, cap;
-        u = std::get<0>(edge);
-        v = std::get<1>(edge);
-        cap = std::get<2>(edge);
-        dinic.addEdge(u, v, cap);
+        stats.phases++;
+        for (int i = 0; i < reached; i++)
+            start[bfsQueue[i]] = g.first[bfsQueue[i]];
+        total += blockingFlow(s, t, limit - total);
     }
-    int max_flow = dinic.maxFlow(s, t);
+    return total;
+}
 
-    // Compose JSON output.
-    stringstream ss;
-    ss << "{";
-    ss << "\"algorithm\":\"Dinic Algorithm\",";
-    ss << "\"maxFlow\":" << max_flow << ",";
-    ss << "\"edgeFlows\":[";
-    for (int i = 0; i < originalEdges.size(); i++)
-    {
-        int u, v, cap;
-        tie(u, v, cap) = originalEdges[i];
-        int flowFound = 0;
-        for (auto &e : dinic.adj[u])
-        {
-            if (e.v == v)
-            {
-                flowFound = e.flow;
-                break;
-            }
-        }
-        ss << "{";
-        ss << "\"u\":" << u << ",";
-        ss << "\"v\":" << v << ",";
-        ss << "\"cap\":" << cap << ",";
-        ss << "\"flow\":" << flowFound;
-        ss << "}";
-        if (i < originalEdges.size() - 1)
-            ss << ",";
-    }
-    ss << "]";
-    ss << "}";
-    cout << ss.str();
+template <typename Cap>
+void runDinic(const Graph &graph, ResultWriter &out, DinicLabels labels)
+{
+    int s = graph.src, t = graph.sink;
+    StageTimer timer;
+    ResidualGraph<Cap> rg(graph, out.memory());
+    Dinic<Cap> dinic(rg, labels);
+    out.stats.buildSeconds += timer.lap();
+    Cap max_flow = dinic.maxFlow(s, t);
+    out.stats.solveSeconds += timer.lap();
+    out.stats += dinic.stats;
+
+    // Stream JSON output.
+    out.begin("Dinic Algorithm");
+    out.field("maxFlow", max_flow);
+    out.cutEdges(rg, s, t);
+    out.edgeFlows(graph, rg);
+    out.end();
 }
 
+template struct Dinic<int>;
+template struct Dinic<long long>;
+template struct Dinic<double>;
+template void runDinic<int>(const Graph &graph, ResultWriter &out, DinicLabels labels);
+template void runDinic<long long>(const Graph &graph, ResultWriter &out, DinicLabels labels);
+template void runDinic<double>(const Graph &graph, ResultWriter &out, DinicLabels labels);
+
 /*
 TC Analysis:
   - Worst-case: O(V^2 * E) but typically O(E * sqrt(V)) in many cases.
+  - Each blocking-flow pass is O(V * E); retreating only to the bottleneck
+    keeps the advance/retreat work per path at O(V).
+  - A phase only scans and resets the nodes its BFS reached, which stops at
+    the other terminal's layer, so phases with s and t close together cost
+    far less than O(V + E).
 SC Analysis:
-  - O(V + E)
+  - O(V + E), with no recursion.
 */
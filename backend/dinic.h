@@ -2,8 +2,54 @@
 #define DINIC_H
 
 #include "graph.h"
+#include "result_writer.h"
+#include "residual_graph.h"
+#include "solver_stats.h"
+#include <limits>
 using namespace std;
 
-void runDinic(const Graph &graph);
+// How bfs() builds the level graph. Forward searches from s; Reverse
+// searches backwards from t over the residual arcs into each node, so every
+// labelled node has a shortest path on to t and the blocking flow does not
+// dead-end on branches that miss it. Both stop at the layer that reaches the
+// other terminal.
+enum class DinicLabels
+{
+    Forward,
+    Reverse
+};
+
+// Dinic max-flow over a shared residual graph. Cap is the capacity type;
+// int, long long and double are instantiated in dinic.cpp.
+template <typename Cap>
+struct Dinic
+{
+    ResidualGraph<Cap> &g;
+    DinicLabels labels;
+    // Allocated once from the graph's memory resource and reused by every
+    // phase.
+    pmr::vector<int> level, start, path;
+    // The nodes the last bfs() labelled are bfsQueue[0 .. reached - 1]; only
+    // they are reset by the next phase, so a phase near s costs time in
+    // what it reaches rather than in V.
+    pmr::vector<int> bfsQueue;
+    int reached = 0;
+    SolverStats stats;
+
+    Dinic(ResidualGraph<Cap> &g, DinicLabels labels = DinicLabels::Forward);
+
+    // Labels the level graph: level[s] = 0 and every admissible arc goes up
+    // one level, ending at t. When no path is left the forward search has
+    // labelled exactly s's side of the min cut.
+    bool bfs(int s, int t);
+    bool forwardBfs(int s, int t);
+    bool reverseBfs(int s, int t);
+    Cap blockingFlow(int s, int t, Cap limit);
+    // Augments the current flow; stops early once limit more units are sent.
+    Cap maxFlow(int s, int t, Cap limit = numeric_limits<Cap>::max());
+};
+
+template <typename Cap = Capacity>
+void runDinic(const Graph &graph, ResultWriter &out, DinicLabels labels = DinicLabels::Forward);
 
 #endif // DINIC_H
@@ -1,92 +1,199 @@
 #include "edmonds_karp.h"
-#include <climits>
-#include <queue>
+#include "residual_graph.h"
+#include "solver_stats.h"
 #include <vector>
-#include <sstream>
 using namespace std;
 
-void runEdmondsKarp(const Graph &graph)
+// Shortest augmenting path search over the residual arcs with at least delta
+// left. The arrays are reused by every search, and reset() clears only the
+// nodes the last search labelled.
+struct PathSearch
 {
-    int n = graph.n, s = graph.src, t = graph.sink;
-    vector<vector<int>> capacity(n, vector<int>(n, 0));
-    // Save a copy of the original capacities for each edge.
-    vector<vector<int>> original(n, vector<int>(n, 0));
+    const ResidualGraph<Capacity> &g;
+    SolverStats &stats;
+    // parentArc[v] is the arc that reached v from s and childArc[v] the arc
+    // that leads on from v towards t; -2 marks the terminal itself.
+    pmr::vector<int> parentArc, childArc, sourceQueue, sinkQueue;
+    int sourceReached = 0, sinkReached = 0;
+    pmr::vector<int> path; // arcs of the path found, in no particular order
 
-    for (auto &edge : graph.edges)
+    PathSearch(const ResidualGraph<Capacity> &g, SolverStats &stats, bool bidirectional)
+        : g(g), stats(stats), parentArc(g.n, -1, g.memory()),
+          childArc(bidirectional ? g.n : 0, -1, g.memory()), sourceQueue(g.n, 0, g.memory()),
+          sinkQueue(bidirectional ? g.n : 0, 0, g.memory()), path(g.memory())
     {
-        int u, v, cap;
-        u = std::get<0>(edge);
-        v = std::get<1>(edge);
-        cap = std::get<2>(edge);
-        capacity[u][v] += cap;
-        original[u][v] = capacity[u][v];
     }
-    int max_flow = 0;
-    vector<int> parent(n, -1);
-    while (true)
+
+    // BFS from s that stops once t is labelled.
+    bool forward(int s, int t, Capacity delta)
     {
-        fill(parent.begin(), parent.end(), -1);
-        parent[s] = s;
-        queue<int> q;
-        q.push(s);
-        while (!q.empty() && parent[t] == -1)
+        parentArc[s] = -2;
+        int *q = sourceQueue.data();
+        int qh = 0, qt = 0;
+        q[qt++] = s;
+        while (qh < qt && parentArc[t] == -1)
         {
-            int u = q.front();
-            q.pop();
-            for (int v = 0; v < n; v++)
+            int u = q[qh++];
+            stats.arcScans += g.first[u + 1] - g.first[u];
+            for (int a = g.first[u]; a < g.first[u + 1]; a++)
             {
-                if (capacity[u][v] > 0 && parent[v] == -1)
+                int v = g.head[a];
+                if (g.cap[a] >= delta && parentArc[v] == -1)
                 {
-                    parent[v] = u;
-                    q.push(v);
+                    parentArc[v] = a;
+                    q[qt++] = v;
                 }
             }
         }
-        if (parent[t] == -1)
-            break;
-        int flow = INT_MAX;
-        for (int cur = t; cur != s; cur = parent[cur])
-            flow = min(flow, capacity[parent[cur]][cur]);
-        for (int cur = t; cur != s; cur = parent[cur])
+        sourceReached = qt;
+        if (parentArc[t] == -1)
+            return false;
+        path.clear();
+        for (int v = t; v != s; v = g.tail(parentArc[v]))
+            path.push_back(parentArc[v]);
+        return true;
+    }
+
+    // BFS from s and, over reversed residual arcs, from t at the same time,
+    // growing whichever frontier is smaller by a whole layer. The first node
+    // labelled from both sides lies on a shortest path: had a shorter one
+    // existed, two earlier layers would already have met on it. Each side
+    // only covers about half the distance, which on wide graphs is a small
+    // fraction of what one search from s reaches.
+    bool bidirectional(int s, int t, Capacity delta)
+    {
+        parentArc[s] = -2;
+        childArc[t] = -2;
+        int *fq = sourceQueue.data(), *bq = sinkQueue.data();
+        int fh = 0, ft = 0, bh = 0, bt = 0;
+        fq[ft++] = s;
+        bq[bt++] = t;
+        int meet = -1;
+        while (meet < 0 && fh < ft && bh < bt)
         {
-            int u = parent[cur];
-            capacity[u][cur] -= flow;
-            capacity[cur][u] += flow;
+            if (ft - fh <= bt - bh)
+            {
+                for (int end = ft; fh < end && meet < 0; fh++)
+                {
+                    int u = fq[fh];
+                    stats.arcScans += g.first[u + 1] - g.first[u];
+                    for (int a = g.first[u]; a < g.first[u + 1]; a++)
+                    {
+                        int v = g.head[a];
+                        if (g.cap[a] >= delta && parentArc[v] == -1)
+                        {
+                            parentArc[v] = a;
+                            fq[ft++] = v;
+                            if (childArc[v] != -1)
+                            {
+                                meet = v;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+            else
+            {
+                for (int end = bt; bh < end && meet < 0; bh++)
+                {
+                    int v = bq[bh];
+                    stats.arcScans += g.first[v + 1] - g.first[v];
+                    for (int b = g.first[v]; b < g.first[v + 1]; b++)
+                    {
+                        int u = g.head[b], a = g.rev[b];
+                        if (g.cap[a] >= delta && childArc[u] == -1)
+                        {
+                            childArc[u] = a;
+                            bq[bt++] = u;
+                            if (parentArc[u] != -1)
+                            {
+                                meet = u;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
         }
-        max_flow += flow;
+        sourceReached = ft;
+        sinkReached = bt;
+        if (meet < 0)
+            return false;
+        path.clear();
+        for (int v = meet; v != s; v = g.tail(parentArc[v]))
+            path.push_back(parentArc[v]);
+        for (int v = meet; v != t; v = g.head[childArc[v]])
+            path.push_back(childArc[v]);
+        return true;
+    }
+
+    void reset()
+    {
+        for (int i = 0; i < sourceReached; i++)
+            parentArc[sourceQueue[i]] = -1;
+        for (int i = 0; i < sinkReached; i++)
+            childArc[sinkQueue[i]] = -1;
     }
+};
+
+void runEdmondsKarp(const Graph &graph, ResultWriter &out, bool capacityScaling, bool bidirectional)
+{
+    int s = graph.src, t = graph.sink;
+    StageTimer timer;
+    ResidualGraph<Capacity> rg(graph, out.memory());
 
-    // Build JSON output.
-    stringstream ss;
-    ss << "{";
-    ss << "\"algorithm\":\"Edmonds-Karp Algorithm\",";
-    ss << "\"maxFlow\":" << max_flow << ",";
-    ss << "\"edgeFlows\":[";
-    // For each original edge, compute flow as (original - residual)
-    bool first = true;
-    for (auto &edge : graph.edges)
+    Capacity max_flow = 0;
+    PathSearch search(rg, out.stats, bidirectional);
+    // Without scaling every arc with capacity left counts.
+    Capacity delta = 1;
+    if (capacityScaling)
     {
-        int u, v, cap;
-        tie(u, v, cap) = edge;
-        int flowFound = original[u][v] - capacity[u][v];
-        if (!first)
-            ss << ",";
-        ss << "{";
-        ss << "\"u\":" << u << ",";
-        ss << "\"v\":" << v << ",";
-        ss << "\"cap\":" << cap << ",";
-        ss << "\"flow\":" << flowFound;
-        ss << "}";
-        first = false;
+        Capacity top = 0;
+        for (const auto &e : graph.edges)
+            top = max(top, get<2>(e));
+        while (delta <= top / 2)
+            delta *= 2;
     }
-    ss << "]";
-    ss << "}";
-    cout << ss.str();
+    out.stats.buildSeconds += timer.lap();
+    while (s != t)
+    {
+        bool found = bidirectional ? search.bidirectional(s, t, delta) : search.forward(s, t, delta);
+        search.reset();
+        out.stats.phases++;
+        if (!found)
+        {
+            if (delta == 1)
+                break;
+            delta /= 2;
+            continue;
+        }
+        Capacity flow = rg.cap[search.path[0]];
+        for (int a : search.path)
+            flow = min(flow, rg.cap[a]);
+        for (int a : search.path)
+            rg.push(a, flow);
+        max_flow += flow;
+        out.stats.augmentations++;
+    }
+    out.stats.solveSeconds += timer.lap();
+
+    // Stream JSON output.
+    out.begin("Edmonds-Karp Algorithm");
+    out.field("maxFlow", max_flow);
+    out.cutEdges(rg, s, t);
+    out.edgeFlows(graph, rg);
+    out.end();
 }
 
 /*
 TC Analysis:
   - Worst-case: O(V * E^2)
+  - Capacity scaling: each delta phase ends with a cut of residual capacity
+    under 2 * delta * E, so it makes at most 2E augmentations of O(E) each:
+    O(E^2 * log U) for the largest capacity U.
+  - Each search stops at t, or where the two sides meet, and resets only
+    the nodes it labelled.
 SC Analysis:
-  - O(V^2)
+  - O(V + E)
 */
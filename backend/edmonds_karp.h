@@ -2,8 +2,17 @@
 #define EDMONDS_KARP_H
 
 #include "graph.h"
+#include "result_writer.h"
 using namespace std;
 
-void runEdmondsKarp(const Graph &graph);
+// With capacityScaling, each BFS only uses residual arcs of at least delta,
+// which starts at the largest power of two not above the biggest capacity
+// and halves whenever no such path is left. That takes O(E log U)
+// augmentations instead of O(V * E), which matters on graphs with huge
+// capacities. With bidirectional, each augmenting path is found by searching
+// from s and t at once until the two searches meet. The result is written the
+// same way in every mode.
+void runEdmondsKarp(const Graph &graph, ResultWriter &out, bool capacityScaling = false,
+                    bool bidirectional = false);
 
 #endif // EDMONDS_KARP_H
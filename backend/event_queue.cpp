@@ -0,0 +1,90 @@
+#include "event_queue.h"
+#include <algorithm>
+using namespace std;
+
+static const size_t MIN_BUCKETS = 16;
+
+EventQueue::EventQueue() : buckets(MIN_BUCKETS)
+{
+    dayEnd = (uint64_t)1 << shift;
+}
+
+void EventQueue::push(const Event &e)
+{
+    buckets[bucketOf(e.time)].push_back(e);
+    if (++count > 2 * buckets.size())
+        resize(2 * buckets.size(), last);
+}
+
+Event EventQueue::pop()
+{
+    for (size_t empty = 0;; empty++)
+    {
+        // A whole year without an event in its window: the width is too
+        // small for the gaps, so refit it and jump to the earliest event.
+        if (empty == buckets.size())
+        {
+            uint64_t earliest = UINT64_MAX;
+            for (const vector<Event> &b : buckets)
+                for (const Event &e : b)
+                    earliest = min(earliest, e.time);
+            resize(buckets.size(), earliest);
+            empty = 0;
+        }
+        vector<Event> &b = buckets[day];
+        size_t best = b.size();
+        for (size_t i = 0; i < b.size(); i++)
+            if (b[i].time < dayEnd && (best == b.size() || b[i].time < b[best].time))
+                best = i;
+        if (best < b.size())
+        {
+            Event e = b[best];
+            b[best] = b.back();
+            b.pop_back();
+            last = e.time;
+            if (--count < buckets.size() / 2 && buckets.size() > MIN_BUCKETS)
+                resize(buckets.size() / 2, last);
+            return e;
+        }
+        day = (day + 1) & (buckets.size() - 1);
+        dayEnd += (uint64_t)1 << shift;
+    }
+}
+
+void EventQueue::resize(size_t n, uint64_t from)
+{
+    vector<Event> events;
+    events.reserve(count);
+    for (vector<Event> &b : buckets)
+    {
+        events.insert(events.end(), b.begin(), b.end());
+        b.clear();
+    }
+    // Width: a power of two near three times the mean gap between events.
+    if (events.size() > 1)
+    {
+        uint64_t lo = UINT64_MAX, hi = 0;
+        for (const Event &e : events)
+        {
+            lo = min(lo, e.time);
+            hi = max(hi, e.time);
+        }
+        uint64_t gap = 3 * ((hi - lo) / events.size()) + 1;
+        shift = highestBit(gap);
+    }
+    buckets.resize(n);
+    for (const Event &e : events)
+        buckets[bucketOf(e.time)].push_back(e);
+    day = bucketOf(from);
+    dayEnd = ((from >> shift) + 1) << shift;
+}
+
+/*
+TC Analysis:
+  - push / pop: O(1) on average when event times are spread evenly; a
+    resize is O(events + buckets) and happens after the queue has doubled
+    or halved, or when a whole year passes without an event.
+SC Analysis:
+  - O(events queued at once + buckets); buckets keep their memory between
+    resizes.
+*/
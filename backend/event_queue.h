@@ -0,0 +1,78 @@
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+using namespace std;
+
+// Index of the highest set bit of x, which must be nonzero.
+inline int highestBit(uint64_t x)
+{
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanReverse64(&bit, x);
+    return (int)bit;
+#else
+    return 63 - __builtin_clzll(x);
+#endif
+}
+
+// Index of the lowest set bit of x, which must be nonzero.
+inline int lowestBit(uint64_t x)
+{
+#ifdef _MSC_VER
+    unsigned long bit;
+    _BitScanForward64(&bit, x);
+    return (int)bit;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+// A timed event: what happens is up to the caller's kind and id.
+struct Event
+{
+    uint64_t time;
+    uint32_t kind;
+    uint32_t id;
+};
+
+// Calendar queue (Brown, 1988) for discrete-event simulation: time is cut
+// into buckets of one width, wrapping around every buckets * width like the
+// days of a year, and pop() drains the current day before moving to the
+// next. The width tracks the mean gap between queued events and the bucket
+// count tracks their number, so a day holds about one event and push / pop
+// are O(1) on average. Events may not be pushed earlier than the last one
+// popped, which holds when each event only schedules later ones. Buckets
+// keep their memory, so a long run stops allocating once warmed up.
+class EventQueue
+{
+public:
+    EventQueue();
+
+    void push(const Event &e);
+    // Earliest event; the queue must not be empty. Ties come out in no
+    // particular order.
+    Event pop();
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+private:
+    vector<vector<Event>> buckets; // a power of two of them
+    int shift = 10;                // bucket width is 1 << shift
+    size_t day = 0;                // bucket being drained
+    uint64_t dayEnd;               // end of its current window
+    uint64_t last = 0;             // time of the last event popped
+    size_t count = 0;
+
+    size_t bucketOf(uint64_t time) const { return (time >> shift) & (buckets.size() - 1); }
+    // Rebuilds with n buckets and a width fitted to the queued events, then
+    // moves to the day of `from`.
+    void resize(size_t n, uint64_t from);
+};
+
+#endif // EVENT_QUEUE_H
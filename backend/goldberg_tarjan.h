@@ -2,8 +2,20 @@
 #define GOLDBERG_TARJAN_H
 
 #include "graph.h"
+#include "result_writer.h"
 using namespace std;
 
-void runGoldbergTarjan(const Graph &graph);
+// Order in which active (overflowing) nodes are discharged.
+enum class PushRelabelOrder
+{
+    HighestLabel,
+    FIFO
+};
+
+// In cut-only mode (out.cutOnly) the solver stops after the first phase,
+// which already yields the min cut, and skips converting the preflow into a
+// flow.
+void runGoldbergTarjan(const Graph &graph, ResultWriter &out,
+                       PushRelabelOrder order = PushRelabelOrder::HighestLabel);
 
 #endif // GOLDBERG_TARJAN_H
@@ -6,12 +6,55 @@
 #include <tuple>
 using namespace std;
 
+// Link capacities are 64-bit so aggregated Tbps links fit when given in bps.
+typedef long long Capacity;
+
 // Graph structure with number of nodes (n), source, sink,
 // and edges represented as (u, v, capacity)
 struct Graph
 {
     int n, src, sink;
-    vector<tuple<int, int, int>> edges;
+    vector<tuple<int, int, Capacity>> edges;
+    // Optional per-edge cost (e.g. latency), parallel to edges; empty means
+    // every edge costs 1.
+    vector<long long> costs;
+
+    long long edgeCost(size_t i) const { return costs.empty() ? 1 : costs[i]; }
+};
+
+// New capacity for input edge `edge` (0-based, in input order).
+struct CapacityUpdate
+{
+    size_t edge;
+    Capacity cap;
+};
+
+// One what-if variant of a base graph: its own source and sink plus
+// capacity overrides (a failed edge is an override to 0).
+struct Scenario
+{
+    int src, sink;
+    vector<CapacityUpdate> updates;
+};
+
+// One source or sink of a multi-terminal flow: amount is the most it can
+// supply (or absorb); a negative amount means no limit.
+struct Terminal
+{
+    int node;
+    Capacity amount;
+};
+
+struct Terminals
+{
+    vector<Terminal> sources, sinks;
+};
+
+// One traffic-matrix entry: demand units from src to sink.
+struct Commodity
+{
+    int src, sink;
+    Capacity demand;
 };
 
 #endif // GRAPH_H
@@ -0,0 +1,311 @@
+#include "graph_io.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+static const char BINARY_MAGIC[8] = {'F', 'L', 'O', 'W', 'G', 'R', 'P', 'H'};
+
+// Whitespace-skipping integer scanner over a raw buffer.
+struct Scanner
+{
+    const char *p, *end;
+
+    template <typename T>
+    bool next(T &value)
+    {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+            p++;
+        auto res = from_chars(p, end, value);
+        if (res.ec != errc())
+            return false;
+        p = res.ptr;
+        return true;
+    }
+
+    // True once only whitespace is left.
+    bool atEnd()
+    {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+            p++;
+        return p == end;
+    }
+
+    // Like next(), but only looks at the rest of the current line.
+    template <typename T>
+    bool nextOnLine(T &value)
+    {
+        while (p < end && (*p == ' ' || *p == '\r' || *p == '\t'))
+            p++;
+        if (p == end || *p == '\n')
+            return false;
+        return next(value);
+    }
+};
+
+static bool parseBinaryGraph(const char *data, size_t size, Graph &graph)
+{
+    BinaryGraphHeader h;
+    if (size < sizeof(h))
+        return false;
+    memcpy(&h, data, sizeof(h));
+    bool hasCosts = h.flags & BINARY_GRAPH_COSTS;
+    size_t columns = 2 * sizeof(int32_t) + (hasCosts ? 2 : 1) * sizeof(int64_t);
+    // Checked by division so a hostile m cannot wrap the size product.
+    if (h.version != 1 || h.n <= 0 || h.m < 0 || (uint64_t)h.m > (size - sizeof(h)) / columns)
+        return false;
+    if (h.src < 0 || h.src >= h.n || h.sink < 0 || h.sink >= h.n)
+        return false;
+    size_t m = h.m;
+    graph.n = h.n;
+    graph.src = h.src;
+    graph.sink = h.sink;
+    const char *us = data + sizeof(h);
+    const char *vs = us + m * sizeof(int32_t);
+    const char *caps = vs + m * sizeof(int32_t);
+    graph.edges.resize(m);
+    for (size_t i = 0; i < m; i++)
+    {
+        int32_t u, v;
+        int64_t cap;
+        memcpy(&u, us + i * sizeof(u), sizeof(u));
+        memcpy(&v, vs + i * sizeof(v), sizeof(v));
+        memcpy(&cap, caps + i * sizeof(cap), sizeof(cap));
+        if (u < 0 || u >= h.n || v < 0 || v >= h.n)
+            return false;
+        graph.edges[i] = make_tuple(u, v, cap);
+    }
+    if (hasCosts)
+    {
+        graph.costs.resize(m);
+        memcpy(graph.costs.data(), caps + m * sizeof(int64_t), m * sizeof(int64_t));
+    }
+    return true;
+}
+
+bool parseGraph(const char *data, size_t size, Graph &graph)
+{
+    graph.edges.clear();
+    graph.costs.clear();
+    if (size >= sizeof(BINARY_MAGIC) && memcmp(data, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0)
+        return parseBinaryGraph(data, size, graph);
+
+    Scanner in{data, data + size};
+    if (!(in.next(graph.n) && in.next(graph.src) && in.next(graph.sink)))
+        return false;
+    if (graph.n <= 0 || graph.src < 0 || graph.src >= graph.n || graph.sink < 0 || graph.sink >= graph.n)
+        return false;
+    // One edge per line; reserving up front avoids regrowth copies.
+    graph.edges.reserve(count(in.p, in.end, '\n'));
+    int u, v;
+    Capacity cap;
+    long long cost;
+    while (!in.atEnd())
+    {
+        // A bad token or a cut-off edge line fails the whole parse.
+        if (!(in.next(u) && in.next(v) && in.next(cap)))
+            return false;
+        if (u < 0 || u >= graph.n || v < 0 || v >= graph.n)
+            return false;
+        // Costs are only stored once some edge has one; earlier edges cost 1.
+        if (in.nextOnLine(cost))
+        {
+            if (graph.costs.empty())
+                graph.costs.assign(graph.edges.size(), 1);
+            graph.costs.push_back(cost);
+        }
+        else if (!graph.costs.empty())
+        {
+            graph.costs.push_back(1);
+        }
+        graph.edges.push_back(make_tuple(u, v, cap));
+    }
+    return true;
+}
+
+bool readGraph(istream &in, Graph &graph)
+{
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    return parseGraph(data.data(), data.size(), graph);
+}
+
+bool readUpdateBatches(istream &in, vector<vector<CapacityUpdate>> &batches)
+{
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    Scanner sc{data.data(), data.data() + data.size()};
+    size_t k;
+    while (sc.next(k))
+    {
+        batches.emplace_back(k);
+        for (CapacityUpdate &u : batches.back())
+            if (!(sc.next(u.edge) && sc.next(u.cap)))
+                return false;
+    }
+    // Anything left over is not a batch count.
+    while (sc.p < sc.end && isspace((unsigned char)*sc.p))
+        sc.p++;
+    return sc.p == sc.end;
+}
+
+bool readScenarios(istream &in, const Graph &base, vector<Scenario> &scenarios)
+{
+    string line;
+    while (getline(in, line))
+    {
+        istringstream words(line);
+        string word;
+        if (!(words >> word) || word[0] == '#')
+            continue;
+        Scenario sc{base.src, base.sink, {}};
+        do
+        {
+            CapacityUpdate up{0, 0};
+            bool ok;
+            if (word == "src")
+                ok = (bool)(words >> sc.src) && sc.src >= 0 && sc.src < base.n;
+            else if (word == "sink")
+                ok = (bool)(words >> sc.sink) && sc.sink >= 0 && sc.sink < base.n;
+            else if (word == "fail")
+                ok = (bool)(words >> up.edge);
+            else if (word == "cap")
+                ok = (bool)(words >> up.edge >> up.cap) && up.cap >= 0;
+            else
+                ok = false;
+            if (!ok)
+                return false;
+            if (word == "fail" || word == "cap")
+            {
+                if (up.edge >= base.edges.size())
+                    return false;
+                sc.updates.push_back(up);
+            }
+        } while (words >> word);
+        scenarios.push_back(move(sc));
+    }
+    return true;
+}
+
+bool readTerminals(istream &in, const Graph &base, Terminals &terminals)
+{
+    vector<char> listed(base.n, 0);
+    string line;
+    while (getline(in, line))
+    {
+        istringstream words(line);
+        string word;
+        if (!(words >> word) || word[0] == '#')
+            continue;
+        Terminal term{0, -1};
+        if ((word != "source" && word != "sink") || !(words >> term.node) || term.node < 0 ||
+            term.node >= base.n || listed[term.node])
+            return false;
+        if (words >> term.amount)
+        {
+            if (term.amount < 0)
+                return false;
+        }
+        else if (!words.eof())
+            return false;
+        listed[term.node] = 1;
+        (word == "source" ? terminals.sources : terminals.sinks).push_back(term);
+    }
+    return !terminals.sources.empty() && !terminals.sinks.empty();
+}
+
+bool readTrafficMatrix(istream &in, const Graph &base, vector<Commodity> &commodities)
+{
+    string line;
+    while (getline(in, line))
+    {
+        istringstream words(line);
+        Commodity c;
+        if (!(words >> c.src))
+        {
+            // Only blank and comment lines may lack a leading node.
+            words.clear();
+            string word;
+            if (words >> word && word[0] != '#')
+                return false;
+            continue;
+        }
+        if (!(words >> c.sink >> c.demand) || c.src < 0 || c.src >= base.n || c.sink < 0 ||
+            c.sink >= base.n || c.demand < 0)
+            return false;
+        commodities.push_back(c);
+    }
+    return true;
+}
+
+bool loadGraphFile(const string &path, Graph &graph)
+{
+#ifdef _WIN32
+    ifstream in(path, ios::binary);
+    if (!in)
+        return false;
+    return readGraph(in, graph);
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    if (size == 0)
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+    madvise(data, size, MADV_SEQUENTIAL);
+    bool ok = parseGraph((const char *)data, size, graph);
+    munmap(data, size);
+    return ok;
+#endif
+}
+
+bool writeBinaryGraph(const string &path, const Graph &graph)
+{
+    ofstream out(path, ios::binary);
+    if (!out)
+        return false;
+    BinaryGraphHeader h{};
+    memcpy(h.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    h.version = 1;
+    h.flags = graph.costs.empty() ? 0 : BINARY_GRAPH_COSTS;
+    h.n = graph.n;
+    h.src = graph.src;
+    h.sink = graph.sink;
+    h.m = graph.edges.size();
+    out.write((const char *)&h, sizeof(h));
+    vector<int32_t> col(graph.edges.size());
+    for (size_t i = 0; i < graph.edges.size(); i++)
+        col[i] = get<0>(graph.edges[i]);
+    out.write((const char *)col.data(), col.size() * sizeof(int32_t));
+    for (size_t i = 0; i < graph.edges.size(); i++)
+        col[i] = get<1>(graph.edges[i]);
+    out.write((const char *)col.data(), col.size() * sizeof(int32_t));
+    vector<int64_t> caps(graph.edges.size());
+    for (size_t i = 0; i < graph.edges.size(); i++)
+        caps[i] = get<2>(graph.edges[i]);
+    out.write((const char *)caps.data(), caps.size() * sizeof(int64_t));
+    if (!graph.costs.empty())
+        out.write((const char *)graph.costs.data(), graph.costs.size() * sizeof(int64_t));
+    return (bool)out;
+}
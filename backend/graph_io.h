@@ -0,0 +1,65 @@
+#ifndef GRAPH_IO_H
+#define GRAPH_IO_H
+
+#include "graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Text format: "n src sink" followed by one "u v cap [cost]" edge per line
+// until end of input; edges without a cost column cost 1. Binary format: a
+// BinaryGraphHeader followed by the packed arrays int32 u[m], int32 v[m],
+// int64 cap[m] and, if flags has BINARY_GRAPH_COSTS, int64 cost[m], all
+// little-endian.
+const uint32_t BINARY_GRAPH_COSTS = 1;
+
+struct BinaryGraphHeader
+{
+    char magic[8]; // "FLOWGRPH"
+    uint32_t version;
+    uint32_t flags;
+    int32_t n, src, sink;
+    int32_t reserved;
+    int64_t m;
+};
+
+// Parses either format from an in-memory buffer; the binary format is
+// detected by its magic. Returns false if the header is missing.
+bool parseGraph(const char *data, size_t size, Graph &graph);
+
+// Reads the whole stream, then parses it with parseGraph.
+bool readGraph(istream &in, Graph &graph);
+
+// Memory-maps a graph file (text or binary) and parses it in place.
+bool loadGraphFile(const string &path, Graph &graph);
+
+// Update batches for incremental solving: each batch is a count k followed
+// by k "edge cap" pairs, repeated until end of input. Batches apply on top of
+// each other, so restoring a failed link is an update back to its capacity.
+bool readUpdateBatches(istream &in, vector<vector<CapacityUpdate>> &batches);
+
+// Scenario list for batch solving, one scenario per line built from the
+// words "src <node>", "sink <node>", "fail <edge>" and "cap <edge> <cap>";
+// src and sink default to the base graph's. Blank lines and lines starting
+// with '#' are skipped. Returns false on an unknown word or an out-of-range
+// node or edge.
+bool readScenarios(istream &in, const Graph &base, vector<Scenario> &scenarios);
+
+// Source and sink sets, one "source <node> [supply]" or "sink <node>
+// [demand]" per line; without an amount the terminal is unlimited. Blank
+// lines and lines starting with '#' are skipped. Returns false on an unknown
+// word, an out-of-range node, a node listed twice, or an empty set.
+bool readTerminals(istream &in, const Graph &base, Terminals &terminals);
+
+// Traffic matrix, one "src sink demand" per line; blank lines and lines
+// starting with '#' are skipped. Returns false on an out-of-range node or a
+// negative demand.
+bool readTrafficMatrix(istream &in, const Graph &base, vector<Commodity> &commodities);
+
+// Writes graph in the binary format.
+bool writeBinaryGraph(const string &path, const Graph &graph);
+
+#endif // GRAPH_IO_H
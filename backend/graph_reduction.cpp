@@ -0,0 +1,317 @@
+#include "graph_reduction.h"
+#include "residual_graph.h"
+#include <algorithm>
+using namespace std;
+
+// Nodes reachable from start along positive-capacity edges, or, if
+// backward, the nodes that can reach it.
+static vector<char> reachable(const ResidualGraph<Capacity> &rg, int start, bool backward)
+{
+    vector<char> seen(rg.n, 0);
+    vector<int> queue{start};
+    seen[start] = 1;
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+        int v = queue[i];
+        for (int a = rg.first[v]; a < rg.first[v + 1]; a++)
+        {
+            int w = rg.head[a];
+            if (!seen[w] && (backward ? rg.cap[rg.rev[a]] : rg.cap[a]) > 0)
+            {
+                seen[w] = 1;
+                queue.push_back(w);
+            }
+        }
+    }
+    return seen;
+}
+
+// Pieces are kept in intrusive per-node incidence lists: slot 2p links
+// piece p into the list of its tail, slot 2p + 1 into that of its head.
+struct Incidence
+{
+    vector<int> head, degree, next, prev;
+
+    Incidence(int n) : head(n, -1), degree(n, 0) {}
+
+    void link(int slot, int x)
+    {
+        next[slot] = head[x];
+        prev[slot] = -1;
+        if (head[x] >= 0)
+            prev[head[x]] = slot;
+        head[x] = slot;
+        degree[x]++;
+    }
+
+    void unlink(int slot, int x)
+    {
+        if (prev[slot] >= 0)
+            next[prev[slot]] = next[slot];
+        else
+            head[x] = next[slot];
+        if (next[slot] >= 0)
+            prev[next[slot]] = prev[slot];
+        degree[x]--;
+    }
+};
+
+GraphReduction::GraphReduction(const Graph &original) : original(original)
+{
+    int n = original.n, s = original.src, t = original.sink;
+    ResidualGraph<Capacity> rg(original);
+    vector<char> keep(n);
+    {
+        vector<char> fromS = reachable(rg, s, false), toT = reachable(rg, t, true);
+        for (int v = 0; v < n; v++)
+            keep[v] = fromS[v] && toT[v];
+    }
+
+    Incidence inc(n);
+    vector<char> alive;
+    auto newPiece = [&](Piece p) {
+        pieces.push_back(p);
+        alive.push_back(0);
+        inc.next.resize(2 * pieces.size());
+        inc.prev.resize(2 * pieces.size());
+        return (int)pieces.size() - 1;
+    };
+    auto link = [&](int p) {
+        alive[p] = 1;
+        inc.link(2 * p, pieces[p].u);
+        inc.link(2 * p + 1, pieces[p].v);
+    };
+    auto unlink = [&](int p) {
+        alive[p] = 0;
+        inc.unlink(2 * p, pieces[p].u);
+        inc.unlink(2 * p + 1, pieces[p].v);
+    };
+    auto other = [&](int p, int x) { return pieces[p].u == x ? pieces[p].v : pieces[p].u; };
+    auto parallel = [&](int a, int b) {
+        return newPiece({PARALLEL, pieces[a].u, pieces[a].v, pieces[a].cap + pieces[b].cap, a, b});
+    };
+
+    // One piece per useful edge, with parallel edges merged as each node's
+    // arcs are scanned.
+    vector<int> arcEdge(rg.arcCount(), -1), pairPiece(n, -1), pairTail(n, -1);
+    for (size_t i = 0; i < rg.edgeArc.size(); i++)
+        arcEdge[rg.edgeArc[i]] = i;
+    for (int u = 0; u < n; u++)
+    {
+        if (!keep[u] || u == t)
+            continue;
+        for (int a = rg.first[u]; a < rg.first[u + 1]; a++)
+        {
+            int i = arcEdge[a], v = rg.head[a];
+            if (i < 0 || !keep[v] || v == u || v == s || rg.orig[a] <= 0)
+                continue;
+            int p = newPiece({EDGE, u, v, rg.orig[a], i, -1});
+            if (pairTail[v] == u)
+            {
+                unlink(pairPiece[v]);
+                p = parallel(pairPiece[v], p);
+            }
+            pairTail[v] = u;
+            pairPiece[v] = p;
+            link(p);
+        }
+    }
+
+    // A new series piece is merged with an existing one for the same pair
+    // when the smaller endpoint list is short; otherwise it stays a
+    // parallel edge, which is still exact.
+    const int MERGE_SCAN = 64;
+    auto attach = [&](int p) {
+        int u = pieces[p].u, v = pieces[p].v;
+        if (u == v || v == s || u == t)
+            return;
+        int x = inc.degree[u] <= inc.degree[v] ? u : v;
+        if (inc.degree[x] <= MERGE_SCAN)
+            for (int slot = inc.head[x]; slot >= 0; slot = inc.next[slot])
+            {
+                int q = slot / 2;
+                if (pieces[q].u == u && pieces[q].v == v)
+                {
+                    unlink(q);
+                    p = parallel(q, p);
+                    break;
+                }
+            }
+        link(p);
+    };
+
+    // Contract nodes with at most two neighbours until none is left.
+    vector<int> work;
+    vector<char> queued(n, 0);
+    for (int v = 0; v < n; v++)
+        if (keep[v] && v != s && v != t)
+        {
+            work.push_back(v);
+            queued[v] = 1;
+        }
+    while (!work.empty())
+    {
+        int v = work.back();
+        work.pop_back();
+        queued[v] = 0;
+        int nb[2] = {-1, -1};
+        bool more = false;
+        for (int slot = inc.head[v]; slot >= 0 && !more; slot = inc.next[slot])
+        {
+            int w = other(slot / 2, v);
+            if (w == nb[0] || w == nb[1])
+                continue;
+            if (nb[0] < 0)
+                nb[0] = w;
+            else if (nb[1] < 0)
+                nb[1] = w;
+            else
+                more = true;
+        }
+        if (more || nb[0] < 0)
+            continue;
+        // Pieces into and out of v per neighbour, parallel ones merged.
+        int into[2] = {-1, -1}, outof[2] = {-1, -1};
+        while (inc.head[v] >= 0)
+        {
+            int p = inc.head[v] / 2;
+            unlink(p);
+            int k = other(p, v) == nb[0] ? 0 : 1;
+            int &side = pieces[p].v == v ? into[k] : outof[k];
+            side = side < 0 ? p : parallel(side, p);
+        }
+        keep[v] = 0;
+        // With one neighbour, flow through v could only go round a cycle.
+        if (nb[1] >= 0)
+        {
+            for (int k = 0; k < 2; k++)
+                if (into[k] >= 0 && outof[1 - k] >= 0)
+                {
+                    Capacity cap = min(pieces[into[k]].cap, pieces[outof[1 - k]].cap);
+                    attach(newPiece({SERIES, nb[k], nb[1 - k], cap, into[k], outof[1 - k]}));
+                }
+        }
+        for (int w : nb)
+            if (w >= 0 && w != s && w != t && !queued[w])
+            {
+                work.push_back(w);
+                queued[w] = 1;
+            }
+    }
+
+    // Renumber in BFS order from s; s and t always keep a node.
+    vector<int> id(n, -1), order{s};
+    id[s] = 0;
+    for (size_t i = 0; i < order.size(); i++)
+        for (int slot = inc.head[order[i]]; slot >= 0; slot = inc.next[slot])
+        {
+            int w = other(slot / 2, order[i]);
+            if (id[w] < 0)
+            {
+                id[w] = (int)order.size();
+                order.push_back(w);
+            }
+        }
+    if (id[t] < 0)
+    {
+        id[t] = (int)order.size();
+        order.push_back(t);
+    }
+    graph.n = (int)order.size();
+    graph.src = id[s];
+    graph.sink = id[t];
+    for (int u : order)
+        for (int slot = inc.head[u]; slot >= 0; slot = inc.next[slot])
+        {
+            // Even slots sit at the piece's tail.
+            int p = slot / 2;
+            if (slot % 2 == 0)
+            {
+                graph.edges.emplace_back(id[u], id[pieces[p].v], pieces[p].cap);
+                edgePiece.push_back(p);
+            }
+        }
+}
+
+// A parallel piece fills its left side first; a series piece passes the
+// same flow to both sides.
+template <typename Cap>
+vector<Cap> GraphReduction::expandFlows(const vector<Cap> &flows) const
+{
+    vector<Cap> result(original.edges.size(), 0);
+    vector<pair<int, Cap>> stack;
+    for (size_t i = 0; i < flows.size(); i++)
+    {
+        stack.emplace_back(edgePiece[i], flows[i]);
+        while (!stack.empty())
+        {
+            int p = stack.back().first;
+            Cap f = stack.back().second;
+            stack.pop_back();
+            const Piece &piece = pieces[p];
+            if (piece.kind == EDGE)
+            {
+                result[piece.left] = f;
+            }
+            else if (piece.kind == PARALLEL)
+            {
+                Cap left = min(f, (Cap)pieces[piece.left].cap);
+                stack.emplace_back(piece.left, left);
+                stack.emplace_back(piece.right, f - left);
+            }
+            else
+            {
+                stack.emplace_back(piece.left, f);
+                stack.emplace_back(piece.right, f);
+            }
+        }
+    }
+    return result;
+}
+
+// A saturated series piece is cut at its bottleneck; a parallel piece at
+// every branch.
+vector<int> GraphReduction::expandCut(const vector<int> &cutEdges) const
+{
+    vector<int> result, stack;
+    for (int e : cutEdges)
+    {
+        stack.push_back(edgePiece[e]);
+        while (!stack.empty())
+        {
+            const Piece &piece = pieces[stack.back()];
+            stack.pop_back();
+            if (piece.kind == EDGE)
+            {
+                result.push_back(piece.left);
+            }
+            else if (piece.kind == PARALLEL)
+            {
+                stack.push_back(piece.left);
+                stack.push_back(piece.right);
+            }
+            else
+            {
+                bool leftNarrower = pieces[piece.left].cap <= pieces[piece.right].cap;
+                stack.push_back(leftNarrower ? piece.left : piece.right);
+            }
+        }
+    }
+    sort(result.begin(), result.end());
+    return result;
+}
+
+template vector<int> GraphReduction::expandFlows(const vector<int> &flows) const;
+template vector<long long> GraphReduction::expandFlows(const vector<long long> &flows) const;
+template vector<double> GraphReduction::expandFlows(const vector<double> &flows) const;
+
+/*
+TC Analysis:
+  - Pruning and renumbering are BFS passes, O(V + E).
+  - Each contraction removes a node and scans its incident pieces once;
+    merging its result scans at most MERGE_SCAN pieces, so contraction is
+    O(V + E).
+  - Expanding flows or a cut walks each piece tree once: O(E).
+SC Analysis:
+  - O(V + E); every merge or contraction adds one piece.
+*/
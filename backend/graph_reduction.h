@@ -0,0 +1,49 @@
+#ifndef GRAPH_REDUCTION_H
+#define GRAPH_REDUCTION_H
+
+#include "graph.h"
+#include <vector>
+using namespace std;
+
+// Max-flow-preserving simplification of a graph, applied before solving:
+//   - edges that cannot lie on an s-t path are dropped (nodes not reachable
+//     from src or not reaching sink, self-loops, edges into src or out of
+//     sink);
+//   - parallel edges are merged by summing their capacities;
+//   - a node whose only neighbours are a and b is contracted into edges
+//     a -> b and b -> a carrying the bottleneck of each direction;
+//   - the remaining nodes are renumbered in BFS order from src.
+// Costs are dropped, so the result is only meant for max-flow solvers.
+struct GraphReduction
+{
+    const Graph &original;
+    Graph graph; // the reduced graph
+
+    GraphReduction(const Graph &original);
+
+    // Flow on every original edge, given the flow on every reduced edge.
+    template <typename Cap>
+    vector<Cap> expandFlows(const vector<Cap> &flows) const;
+    // Original edges behind a set of reduced cut edges, in input order.
+    vector<int> expandCut(const vector<int> &cutEdges) const;
+
+private:
+    // A reduced edge is a tree of pieces over the original edges.
+    enum PieceKind
+    {
+        EDGE,     // original edge `left`
+        PARALLEL, // left and right side by side
+        SERIES    // left followed by right
+    };
+    struct Piece
+    {
+        PieceKind kind;
+        int u, v;
+        Capacity cap;
+        int left, right;
+    };
+    vector<Piece> pieces;
+    vector<int> edgePiece; // piece behind each reduced edge
+};
+
+#endif // GRAPH_REDUCTION_H
@@ -0,0 +1,39 @@
+#ifndef INCREMENTAL_FLOW_H
+#define INCREMENTAL_FLOW_H
+
+#include "graph.h"
+#include "dinic.h"
+#include "residual_graph.h"
+#include "result_writer.h"
+#include <vector>
+using namespace std;
+
+// Max flow that is kept current while edge capacities change. The previous
+// flow stays in the residual graph: an edge cut below its flow has the excess
+// rerouted or cancelled locally, and Dinic then re-augments from there
+// instead of from zero.
+struct IncrementalMaxFlow
+{
+    int s, t;
+    ResidualGraph<Capacity> g;
+    Dinic<Capacity> dinic;
+    Capacity value = 0;
+
+    IncrementalMaxFlow(const Graph &graph);
+
+    // Changes the capacity of input edge i, keeping the flow feasible.
+    void setCapacity(size_t i, Capacity c);
+    // Applies a batch of updates, then restores a maximum flow.
+    Capacity apply(const vector<CapacityUpdate> &batch);
+    Capacity augment();
+
+private:
+    void repair(int u, int v, Capacity excess);
+};
+
+// Solves graph, then each batch on top of the previous state, writing one
+// NDJSON line per state (batch 0 is the base graph).
+void runIncremental(const Graph &graph, const vector<vector<CapacityUpdate>> &batches,
+                    ResultWriter &out);
+
+#endif // INCREMENTAL_FLOW_H
@@ -1,48 +1,325 @@
 #include <iostream>
+#include <cstdlib>
+#include <fstream>
 #include <sstream>
+#include <memory>
 #include <vector>
 #include <tuple>
 #include "graph.h"
-#include "dinic.h"
-#include "edmonds_karp.h"
-#include "goldberg_tarjan.h"
-#include "mcmf.h"
-#include "boykov_kolmogorov.h"
-#include "min_cut_algorithms.h"
+#include "graph_io.h"
+#include "graph_reduction.h"
+#include "vertex_order.h"
+#include "result_writer.h"
+#include "solvers.h"
+#include "incremental_flow.h"
+#include "multi_commodity.h"
+#include "packet_sim.h"
+#include "scenario_batch.h"
+#include "work_stealing.h"
 using namespace std;
 
+// Long-running mode: each job is a header line "<algorithm> <bytes>"
+// followed by exactly <bytes> of graph text in the usual input format.
+// Every job produces one JSON line on stdout, flushed immediately. The
+// payload, graph and writer buffers are reused from job to job, and so is
+// the solvers' Workspace, so small jobs stop allocating after warm-up.
+static int serve()
+{
+    string algo, payload;
+    size_t bytes;
+    Graph graph;
+    ResultWriter out(cout);
+    // Errors go through the writer so that the algorithm name, which comes
+    // straight from the job header, is escaped.
+    auto error = [&](const string &message) {
+        out.field("error", message.c_str());
+        out.end();
+        out.flush();
+    };
+    while (cin >> algo >> bytes)
+    {
+        cin.ignore(1); // the newline ending the header
+        payload.resize(bytes);
+        cin.read(&payload[0], bytes);
+        if ((size_t)cin.gcount() != bytes)
+        {
+            // Input ended inside the payload, so no further job can follow.
+            error("Truncated job");
+            cout << "\n";
+            cout.flush();
+            return 1;
+        }
+        if (!parseGraph(payload.data(), payload.size(), graph))
+            error("Malformed graph");
+        else
+        {
+            out.stats = SolverStats();
+            if (runAlgorithm(algo, graph, out))
+                out.flush();
+            else
+                error("Unknown algorithm: " + algo);
+        }
+        cout << "\n";
+        cout.flush();
+    }
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
     if (argc < 2)
     {
-        cout << "Usage: flow_solver <algorithm>" << endl;
+        cout << "Usage: flow_solver <algorithm> [--ndjson] [--cut-only] [--reduce] [--reorder bfs|rcm|degree] [--stats] [--paths] [--terminals file] [graph file] | flow_solver --serve"
+             << " | flow_solver --convert <text in> <binary out>"
+             << " | flow_solver --incremental <graph file> <update file>"
+             << " | flow_solver --scenarios <graph file> <scenario file> [--threads N]"
+             << " | flow_solver --multicommodity <graph file> <traffic file> [--epsilon E] [--ndjson] [--stats]"
+             << " | flow_solver --simulate <graph file> [--packets N] [--load L] [--packet-bytes B] [--queue Q]"
+             << " [--seed S] [--stats] (capacities are link rates in bit/s, edge costs propagation delays in"
+             << " microseconds)" << endl;
         return 1;
     }
+    ios::sync_with_stdio(false);
     string algo = argv[1];
+    if (algo == "--serve")
+        return serve();
 
-    int n, s, t;
-    cin >> n >> s >> t;
     Graph graph;
-    graph.n = n;
-    graph.src = s;
-    graph.sink = t;
-    int u, v, cap;
-    while (cin >> u >> v >> cap)
+    if (algo == "--convert")
+    {
+        if (argc < 4 || !loadGraphFile(argv[2], graph) || !writeBinaryGraph(argv[3], graph))
+        {
+            cout << "Conversion failed" << endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (algo == "--incremental")
     {
-        graph.edges.push_back(make_tuple(u, v, cap));
+        vector<vector<CapacityUpdate>> batches;
+        ifstream updates(argc < 4 ? "" : argv[3]);
+        if (argc < 4 || !loadGraphFile(argv[2], graph) || !updates || !readUpdateBatches(updates, batches))
+        {
+            cout << "Cannot read graph or update file" << endl;
+            return 1;
+        }
+        for (const vector<CapacityUpdate> &batch : batches)
+            for (const CapacityUpdate &up : batch)
+                if (up.edge >= graph.edges.size() || up.cap < 0)
+                {
+                    cout << "Invalid update for edge " << up.edge << endl;
+                    return 1;
+                }
+        ResultWriter out(cout, OutputFormat::NDJSON);
+        runIncremental(graph, batches, out);
+        return 0;
+    }
+    if (algo == "--scenarios")
+    {
+        vector<Scenario> scenarios;
+        ifstream list(argc < 4 ? "" : argv[3]);
+        if (argc < 4 || !loadGraphFile(argv[2], graph) || !list || !readScenarios(list, graph, scenarios))
+        {
+            cout << "Cannot read graph or scenario file" << endl;
+            return 1;
+        }
+        int threads = defaultThreadCount();
+        if (argc >= 6 && string(argv[4]) == "--threads")
+            threads = atoi(argv[5]);
+        ResultWriter out(cout, OutputFormat::NDJSON);
+        runScenarioBatch(graph, scenarios, threads, out);
+        return 0;
+    }
+    if (algo == "--multicommodity")
+    {
+        vector<Commodity> commodities;
+        ifstream traffic(argc < 4 ? "" : argv[3]);
+        StageTimer timer;
+        if (argc < 4 || !loadGraphFile(argv[2], graph) || !traffic || !readTrafficMatrix(traffic, graph, commodities))
+        {
+            cout << "Cannot read graph or traffic file" << endl;
+            return 1;
+        }
+        OutputFormat format = OutputFormat::JSON;
+        bool stats = false;
+        double epsilon = 0.1;
+        for (int i = 4; i < argc; i++)
+        {
+            string arg = argv[i];
+            if (arg == "--ndjson")
+                format = OutputFormat::NDJSON;
+            else if (arg == "--stats")
+                stats = true;
+            else if (arg == "--epsilon" && i + 1 < argc)
+                epsilon = atof(argv[++i]);
+        }
+        if (!(epsilon > 0 && epsilon <= 0.5))
+        {
+            cout << "--epsilon must be in (0, 0.5]" << endl;
+            return 1;
+        }
+        ResultWriter out(cout, format);
+        out.reportStats = stats;
+        out.stats.parseSeconds = timer.lap();
+        runMultiCommodity(graph, commodities, epsilon, out);
+        return 0;
+    }
+    if (algo == "--simulate")
+    {
+        StageTimer timer;
+        if (argc < 3 || !loadGraphFile(argv[2], graph))
+        {
+            cout << "Cannot read graph file" << endl;
+            return 1;
+        }
+        SimulationConfig config;
+        bool stats = false;
+        for (int i = 3; i < argc; i++)
+        {
+            string arg = argv[i];
+            bool value = i + 1 < argc;
+            if (arg == "--stats")
+                stats = true;
+            else if (arg == "--packets" && value)
+                config.packets = atoll(argv[++i]);
+            else if (arg == "--load" && value)
+                config.load = atof(argv[++i]);
+            else if (arg == "--packet-bytes" && value)
+                config.packetBytes = atoi(argv[++i]);
+            else if (arg == "--queue" && value)
+                config.queuePackets = atoi(argv[++i]);
+            else if (arg == "--seed" && value)
+                config.seed = atoll(argv[++i]);
+        }
+        if (config.load <= 0 || config.packetBytes <= 0 || config.queuePackets < 0)
+        {
+            cout << "--load and --packet-bytes must be positive, --queue at least 0" << endl;
+            return 1;
+        }
+        // Edge costs are propagation delays and cannot be negative.
+        for (size_t i = 0; i < graph.edges.size(); i++)
+        {
+            if (graph.edgeCost(i) < 0)
+            {
+                cout << "--simulate reads edge costs as delays in microseconds; edge " << i << " is negative"
+                     << endl;
+                return 1;
+            }
+        }
+        ResultWriter out(cout);
+        out.reportStats = stats;
+        out.stats.parseSeconds = timer.lap();
+        runPacketSimulation(graph, config, out);
+        return 0;
+    }
+    OutputFormat format = OutputFormat::JSON;
+    bool cutOnly = false, reduce = false, reorder = false, stats = false, paths = false;
+    VertexOrder order = VertexOrder::BFS;
+    string path, terminalPath;
+    for (int i = 2; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--ndjson")
+            format = OutputFormat::NDJSON;
+        else if (arg == "--cut-only")
+            cutOnly = true;
+        else if (arg == "--reduce")
+            reduce = true;
+        else if (arg == "--stats")
+            stats = true;
+        else if (arg == "--paths")
+            paths = true;
+        else if (arg == "--terminals" && i + 1 < argc)
+            terminalPath = argv[++i];
+        else if (arg == "--reorder" && i + 1 < argc)
+        {
+            reorder = true;
+            if (!parseVertexOrder(argv[++i], order))
+            {
+                cout << "Unknown vertex order: " << argv[i] << endl;
+                return 1;
+            }
+        }
+        else
+            path = arg;
+    }
+    // The reduction keeps the src-sink max flow only: no costs, no other pairs.
+    if (reduce && (algo == "mcmf" || algo == "mcmf_cost_scaling" || algo == "gomory_hu"))
+    {
+        cout << "--reduce only applies to src-sink max-flow algorithms" << endl;
+        return 1;
+    }
+    // The cut tree reports node ids, which a relabeled graph would change.
+    if (reorder && algo == "gomory_hu")
+    {
+        cout << "--reorder does not apply to gomory_hu" << endl;
+        return 1;
+    }
+    if (!terminalPath.empty() && algo == "gomory_hu")
+    {
+        cout << "--terminals does not apply to gomory_hu" << endl;
+        return 1;
+    }
+    // A graph file (text or binary) is memory-mapped; otherwise read stdin.
+    StageTimer timer;
+    if (!path.empty())
+    {
+        if (!loadGraphFile(path, graph))
+        {
+            cout << "Cannot read graph file: " << path << endl;
+            return 1;
+        }
+    }
+    else if (!readGraph(cin, graph))
+    {
+        cout << "Cannot read graph from stdin" << endl;
+        return 1;
+    }
+    // Several sources and sinks are solved as one flow from a super source
+    // to a super sink.
+    Terminals terminals;
+    if (!terminalPath.empty())
+    {
+        ifstream list(terminalPath);
+        if (!list || !readTerminals(list, graph, terminals))
+        {
+            cout << "Cannot read terminal file: " << terminalPath << endl;
+            return 1;
+        }
+        graph = superTerminalGraph(graph, terminals);
     }
 
-    if (algo == "dinic")
-        runDinic(graph);
-    else if (algo == "edmonds_karp")
-        runEdmondsKarp(graph);
-    else if (algo == "goldberg_tarjan")
-        runGoldbergTarjan(graph);
-    else if (algo == "mcmf")
-        runMCMF(graph);
-    else if (algo == "bk")
-        runBoykovKolmogorov(graph);
-    else
+    bool known;
+    {
+        ResultWriter out(cout, format);
+        out.cutOnly = cutOnly;
+        out.paths = paths;
+        out.reportStats = stats;
+        out.stats.parseSeconds = timer.lap();
+        if (!terminalPath.empty())
+            out.terminals = &terminals;
+        const Graph *input = &graph;
+        unique_ptr<GraphReduction> reduction;
+        if (reduce && graph.src != graph.sink)
+        {
+            reduction.reset(new GraphReduction(graph));
+            out.reduction = reduction.get();
+            input = &reduction->graph;
+        }
+        // Solve on renumbered nodes; edge order is unchanged, so only the
+        // node ids written with edgeFlows need mapping back.
+        Graph relabeled;
+        if (reorder && input->n > 0)
+        {
+            relabeled = relabel(*input, vertexOrder(*input, order));
+            out.original = input;
+            input = &relabeled;
+        }
+        // Preprocessing counts as part of building the solver's input.
+        out.stats.buildSeconds += timer.lap();
+        known = runAlgorithm(algo, *input, out);
+    }
+    if (!known)
         cout << "Unknown algorithm: " << algo << endl;
 
     return 0;
@@ -1,119 +1,191 @@
 #include "mcmf.h"
+#include "residual_graph.h"
+#include "solver_stats.h"
 #include <climits>
+#include <functional>
 #include <vector>
-#include <queue>
-#include <sstream>
 #include <algorithm>
 using namespace std;
 
-struct Edge
-{
-    int u, v, cap, cost, flow;
-};
+static const long long INF_COST = LLONG_MAX / 4;
 
-void runMCMF(const Graph &graph)
+// Successive shortest paths with Johnson potentials: one SPFA pass sets the
+// initial potentials (edge costs may be negative), after which every
+// shortest path is found by Dijkstra on non-negative reduced costs.
+struct MinCostFlow
 {
-    int n = graph.n, s = graph.src, t = graph.sink;
-    vector<Edge> edges;
-    vector<vector<int>> adj(n);
+    ResidualGraph<Capacity> &g;
+    int n, s, t;
+    pmr::vector<long long> cost, potential, dist;
+    pmr::vector<int> parentArc;
+    // Dijkstra's binary heap, kept between rounds so it stops allocating
+    // once it has grown.
+    typedef pair<long long, int> Item;
+    pmr::vector<Item> heap;
+    SolverStats stats;
 
-    auto addEdge = [&](int u, int v, int cap, int cost)
+    MinCostFlow(ResidualGraph<Capacity> &g, const Graph &graph)
+        : g(g), n(g.n), s(graph.src), t(graph.sink), cost(g.arcCount(), 0, g.memory()),
+          potential(n, 0, g.memory()), dist(n, 0, g.memory()), parentArc(n, 0, g.memory()),
+          heap(g.memory())
     {
-        Edge a{u, v, cap, cost, 0};
-        Edge b{v, u, 0, -cost, 0};
-        adj[u].push_back(edges.size());
-        edges.push_back(a);
-        adj[v].push_back(edges.size());
-        edges.push_back(b);
-    };
+        for (size_t i = 0; i < g.edgeArc.size(); i++)
+        {
+            int a = g.edgeArc[i];
+            cost[a] = graph.edgeCost(i);
+            cost[g.rev[a]] = -cost[a];
+        }
+    }
 
-    // Insert each graph edge with a cost of 1 
-    for (auto &edge : graph.edges)
+    // Queue-based Bellman-Ford from s. Returns false on a negative-cost
+    // cycle: with finite capacities the min-cost flow still exists, but
+    // successive shortest paths cannot start from one.
+    bool initPotentials()
     {
-        int u, v, cap;
-        tie(u, v, cap) = edge;
-        addEdge(u, v, cap, 1);
+        fill(dist.begin(), dist.end(), INF_COST);
+        pmr::vector<int> passes(n, 0, g.memory()), queue(n, 0, g.memory());
+        pmr::vector<char> queued(n, 0, g.memory());
+        // queued keeps each node in the ring at most once. A round ends once
+        // every node queued during the previous one has been scanned.
+        int head = 0, size = 0, roundLeft = 1;
+        dist[s] = 0;
+        queue[size++] = s;
+        while (size > 0)
+        {
+            int u = queue[head];
+            head = (head + 1) % n;
+            size--;
+            queued[u] = 0;
+            if (++passes[u] > n)
+                return false;
+            for (int a = g.first[u]; a < g.first[u + 1]; a++)
+            {
+                int v = g.head[a];
+                if (g.cap[a] > 0 && dist[u] + cost[a] < dist[v])
+                {
+                    dist[v] = dist[u] + cost[a];
+                    if (!queued[v])
+                    {
+                        queued[v] = 1;
+                        queue[(head + size++) % n] = v;
+                    }
+                }
+            }
+            if (--roundLeft == 0)
+            {
+                stats.bellmanFordRounds++;
+                roundLeft = size;
+            }
+        }
+        // Nodes unreachable from s stay unreachable, so their potential
+        // never matters.
+        for (int v = 0; v < n; v++)
+            potential[v] = dist[v] < INF_COST ? dist[v] : 0;
+        return true;
     }
 
-    int flow = 0, cost = 0;
-    while (true)
+    // Dijkstra on reduced costs; afterwards potentials absorb the distances
+    // so reduced costs stay non-negative for the next round.
+    bool shortestPath()
     {
-        vector<int> dist(n, INT_MAX), parent(n, -1), parentEdge(n, -1);
+        stats.phases++;
+        fill(dist.begin(), dist.end(), INF_COST);
+        heap.clear();
         dist[s] = 0;
-        // Bellman-Ford to compute shortest path by cost.
-        for (int i = 0; i < n - 1; i++)
+        heap.push_back({0, s});
+        while (!heap.empty())
         {
-            for (int u = 0; u < n; u++)
+            pop_heap(heap.begin(), heap.end(), greater<Item>());
+            Item top = heap.back();
+            heap.pop_back();
+            int u = top.second;
+            if (top.first > dist[u])
+                continue;
+            for (int a = g.first[u]; a < g.first[u + 1]; a++)
             {
-                if (dist[u] == INT_MAX)
+                int v = g.head[a];
+                if (g.cap[a] <= 0)
                     continue;
-                for (int idx : adj[u])
+                long long d = dist[u] + cost[a] + potential[u] - potential[v];
+                if (d < dist[v])
                 {
-                    Edge &e = edges[idx];
-                    if (e.cap - e.flow > 0 && dist[e.v] > dist[u] + e.cost)
-                    {
-                        dist[e.v] = dist[u] + e.cost;
-                        parent[e.v] = u;
-                        parentEdge[e.v] = idx;
-                    }
+                    dist[v] = d;
+                    parentArc[v] = a;
+                    heap.push_back({d, v});
+                    push_heap(heap.begin(), heap.end(), greater<Item>());
                 }
             }
         }
-        if (dist[t] == INT_MAX)
-            break;
-        int pushFlow = INT_MAX;
-        for (int v = t; v != s; v = parent[v])
-            pushFlow = min(pushFlow, edges[parentEdge[v]].cap - edges[parentEdge[v]].flow);
-        for (int v = t; v != s; v = parent[v])
+        if (dist[t] == INF_COST)
+            return false;
+        for (int v = 0; v < n; v++)
         {
-            edges[parentEdge[v]].flow += pushFlow;
-            edges[parentEdge[v] ^ 1].flow -= pushFlow;
+            if (dist[v] < INF_COST)
+                potential[v] += dist[v];
         }
-        flow += pushFlow;
-        cost += pushFlow * dist[t];
+        return true;
     }
 
-    // Build JSON output.
-    stringstream ss;
-    ss << "{";
-    ss << "\"algorithm\":\"Min-Cost Max-Flow (MCMF) Algorithm\",";
-    ss << "\"maxFlow\":" << flow << ",";
-    ss << "\"cost\":" << cost << ",";
-    ss << "\"edgeFlows\":[";
-    bool first = true;
-    // For each original edge, search in edges array.
-    for (auto &edge : graph.edges)
+    // Returns false if the costs contain a negative cycle, which this
+    // solver does not handle.
+    bool solve(Capacity &flow, long long &totalCost)
     {
-        int u, v, cap;
-        tie(u, v, cap) = edge;
-        int flowFound = 0;
-        // Find the corresponding edge in our edges vector.
-        for (int i = 0; i < edges.size(); i += 2)
-        { // only even indices represent the original direction.
-            if (edges[i].u == u && edges[i].v == v && edges[i].cap == cap)
+        flow = 0;
+        totalCost = 0;
+        if (s == t)
+            return true;
+        if (!initPotentials())
+            return false;
+        while (shortestPath())
+        {
+            Capacity pushFlow = g.cap[parentArc[t]];
+            long long pathCost = 0;
+            for (int v = t; v != s; v = g.tail(parentArc[v]))
             {
-                flowFound = edges[i].flow;
-                break;
+                pushFlow = min(pushFlow, g.cap[parentArc[v]]);
+                pathCost += cost[parentArc[v]];
             }
+            for (int v = t; v != s; v = g.tail(parentArc[v]))
+                g.push(parentArc[v], pushFlow);
+            flow += pushFlow;
+            totalCost += pushFlow * pathCost;
+            stats.augmentations++;
         }
-        if (!first)
-            ss << ",";
-        ss << "{";
-        ss << "\"u\":" << u << ",";
-        ss << "\"v\":" << v << ",";
-        ss << "\"cap\":" << cap << ",";
-        ss << "\"flow\":" << flowFound;
-        ss << "}";
-        first = false;
+        return true;
+    }
+};
+
+void runMCMF(const Graph &graph, ResultWriter &out)
+{
+    StageTimer timer;
+    ResidualGraph<Capacity> rg(graph, out.memory());
+    MinCostFlow mcf(rg, graph);
+    out.stats.buildSeconds += timer.lap();
+    Capacity flow;
+    long long totalCost;
+    bool ok = mcf.solve(flow, totalCost);
+    out.stats.solveSeconds += timer.lap();
+    out.stats += mcf.stats;
+
+    // Stream JSON output.
+    out.begin("Min-Cost Max-Flow (MCMF) Algorithm");
+    if (!ok)
+    {
+        out.field("error", "mcmf needs a graph without negative-cost cycles; mcmf_cost_scaling accepts them");
+        out.end();
+        return;
     }
-    ss << "]";
-    ss << "}";
-    cout << ss.str();
+    out.field("maxFlow", flow);
+    out.field("cost", totalCost);
+    out.cutEdges(rg, graph.src, graph.sink);
+    out.edgeFlows(graph, rg);
+    out.end();
 }
 
 /*
 TC Analysis:
-  - Worst-case: O(E * F * V) where F is total flow.
+  - O(V * E) for the initial SPFA, then O(F * E * log V) where F is the
+    number of augmenting paths (at most the total flow).
 SC Analysis:
   - O(E + V)
 */
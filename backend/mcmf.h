@@ -2,8 +2,9 @@
 #define MCMF_H
 
 #include "graph.h"
+#include "result_writer.h"
 using namespace std;
 
-void runMCMF(const Graph &graph);
+void runMCMF(const Graph &graph, ResultWriter &out);
 
 #endif // MCMF_H
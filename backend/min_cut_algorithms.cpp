@@ -0,0 +1,139 @@
+#include "min_cut_algorithms.h"
+#include "dinic.h"
+#include "residual_graph.h"
+#include "work_stealing.h"
+#include <algorithm>
+#include <memory>
+using namespace std;
+
+// One worker's residual graph with every edge made two-way: the reverse arc
+// of each edge gets the same capacity as the forward arc.
+struct CutWorker
+{
+    ResidualGraph<Capacity> g;
+    Dinic<Capacity> dinic;
+
+    CutWorker(const Graph &graph) : g(graph), dinic(g)
+    {
+        for (int a : g.edgeArc)
+            g.orig[g.rev[a]] = g.orig[a];
+    }
+
+    // Min s-t cut value; side[v] is set for the nodes on s's side.
+    Capacity cut(int s, int t, vector<char> &side)
+    {
+        copy(g.orig.begin(), g.orig.end(), g.cap.begin());
+        Capacity value = dinic.maxFlow(s, t);
+        // The last BFS found no path, so its levels mark s's residual side.
+        for (int v = 0; v < g.n; v++)
+            side[v] = dinic.level[v] >= 0;
+        return value;
+    }
+};
+
+// Gusfield's step for node s is a cut against its current parent, so a batch
+// of consecutive steps can run speculatively in parallel against the parents
+// known at the start. A step may rewrite any parent, later nodes' and, in the
+// swap case, an earlier node's too, but a cut only depends on its own node's
+// parent. Results are therefore applied in order, and each is re-checked
+// against the parent its cut assumed: the first one that changed ends the
+// batch and is redone in the next. That re-check is what keeps batching
+// sound and must stay.
+GomoryHuTree::GomoryHuTree(const Graph &graph, int threads)
+{
+    int n = graph.n;
+    parent.assign(n, 0);
+    weight.assign(n, 0);
+    depth.assign(n, 0);
+    int batch = max(threads, 1);
+    vector<unique_ptr<CutWorker>> workers(batch);
+    vector<vector<char>> sides(batch, vector<char>(n));
+    vector<int> guessed(batch);
+    vector<Capacity> values(batch);
+
+    for (int s = 1; s < n;)
+    {
+        int k = min(batch, n - s);
+        for (int j = 0; j < k; j++)
+            guessed[j] = parent[s + j];
+        parallelFor(k, threads, [&](int w, size_t j) {
+            if (!workers[w])
+                workers[w].reset(new CutWorker(graph));
+            values[j] = workers[w]->cut(s + (int)j, guessed[j], sides[j]);
+        });
+        int j = 0;
+        for (; j < k && parent[s + j] == guessed[j]; j++)
+        {
+            int u = s + j, t = guessed[j];
+            const vector<char> &side = sides[j];
+            weight[u] = values[j];
+            for (int v = 0; v < n; v++)
+                if (v != u && side[v] && parent[v] == t)
+                    parent[v] = u;
+            // Keeps the tree a cut tree, not just flow-equivalent.
+            if (side[parent[t]])
+            {
+                parent[u] = parent[t];
+                parent[t] = u;
+                weight[u] = weight[t];
+                weight[t] = values[j];
+            }
+        }
+        s += j;
+    }
+
+    // Parents may point to higher-numbered nodes, so depths need a walk.
+    vector<char> known(n, 0);
+    known[0] = 1;
+    vector<int> chain;
+    for (int v = 0; v < n; v++)
+    {
+        int u = v;
+        for (; !known[u]; u = parent[u])
+            chain.push_back(u);
+        for (; !chain.empty(); chain.pop_back())
+        {
+            depth[chain.back()] = depth[u] + 1;
+            known[chain.back()] = 1;
+            u = chain.back();
+        }
+    }
+}
+
+Capacity GomoryHuTree::minCut(int u, int v) const
+{
+    if (u == v)
+        return -1;
+    Capacity best = -1;
+    while (u != v)
+    {
+        if (depth[u] < depth[v])
+            swap(u, v);
+        if (best < 0 || weight[u] < best)
+            best = weight[u];
+        u = parent[u];
+    }
+    return best;
+}
+
+void runGomoryHu(const Graph &graph, ResultWriter &out)
+{
+    StageTimer timer;
+    GomoryHuTree tree(graph, defaultThreadCount());
+    out.stats.solveSeconds += timer.lap();
+
+    out.begin("Gomory-Hu Tree (Gusfield)");
+    out.field("minCut", graph.src == graph.sink ? -1 : tree.minCut(graph.src, graph.sink));
+    out.array("parent", tree.parent);
+    out.array("weight", tree.weight);
+    out.end();
+}
+
+/*
+TC Analysis:
+  - n - 1 Dinic max flows, O(n * V^2 * E) in the worst case, split across the
+    worker threads; a speculative step is redone at most once per batch.
+  - Each tree query walks one path: O(V).
+SC Analysis:
+  - O(threads * (V + E)) for the per-worker residual graphs and cut sides.
+*/
@@ -0,0 +1,28 @@
+#ifndef MIN_CUT_ALGORITHMS_H
+#define MIN_CUT_ALGORITHMS_H
+
+#include "graph.h"
+#include "result_writer.h"
+#include <vector>
+using namespace std;
+
+// Gomory-Hu cut tree built with Gusfield's algorithm: n - 1 max flows on the
+// original graph, no contractions. Links are undirected, so an edge
+// (u, v, cap) carries up to cap in either direction. The min cut between any
+// two nodes is the lightest edge on their tree path.
+struct GomoryHuTree
+{
+    vector<int> parent;       // tree parent; node 0 is the root
+    vector<Capacity> weight;  // min cut between i and parent[i]
+    vector<int> depth;
+
+    // Builds the tree with up to `threads` max flows running at once.
+    GomoryHuTree(const Graph &graph, int threads);
+
+    // Min cut between u and v in O(n); -1 if u == v.
+    Capacity minCut(int u, int v) const;
+};
+
+void runGomoryHu(const Graph &graph, ResultWriter &out);
+
+#endif // MIN_CUT_ALGORITHMS_H
@@ -0,0 +1,357 @@
+#include "multi_commodity.h"
+#include "dinic.h"
+#include "residual_graph.h"
+#include "work_stealing.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+using namespace std;
+
+Graph superTerminalGraph(const Graph &graph, const Terminals &terminals)
+{
+    int n = graph.n;
+    vector<Capacity> outCap(n, 0), inCap(n, 0);
+    for (const auto &e : graph.edges)
+    {
+        outCap[get<0>(e)] += get<2>(e);
+        inCap[get<1>(e)] += get<2>(e);
+    }
+    Graph result = graph;
+    result.n = n + 2;
+    result.src = n;
+    result.sink = n + 1;
+    for (const Terminal &t : terminals.sources)
+        result.edges.emplace_back(n, t.node, t.amount < 0 ? outCap[t.node] : t.amount);
+    for (const Terminal &t : terminals.sinks)
+        result.edges.emplace_back(t.node, n + 1, t.amount < 0 ? inCap[t.node] : t.amount);
+    if (!result.costs.empty())
+        result.costs.resize(result.edges.size(), 0);
+    return result;
+}
+
+// Max flow of every commodity routed alone, on per-worker residual graphs
+// reset between commodities.
+static vector<Capacity> singleCommodityFlows(const Graph &graph, const vector<Commodity> &commodities)
+{
+    struct Worker
+    {
+        ResidualGraph<Capacity> g;
+        Dinic<Capacity> dinic;
+
+        Worker(const Graph &graph) : g(graph), dinic(g) {}
+    };
+    vector<Capacity> flows(commodities.size(), 0);
+    int threads = defaultThreadCount();
+    vector<unique_ptr<Worker>> workers(max(threads, 1));
+    parallelFor(commodities.size(), threads, [&](int w, size_t i) {
+        const Commodity &c = commodities[i];
+        if (c.demand == 0 || c.src == c.sink)
+            return;
+        if (!workers[w])
+            workers[w].reset(new Worker(graph));
+        copy(workers[w]->g.orig.begin(), workers[w]->g.orig.end(), workers[w]->g.cap.begin());
+        flows[i] = workers[w]->dinic.maxFlow(c.src, c.sink);
+    });
+    return flows;
+}
+
+// Edge lengths start at delta / cap and grow by (1 + epsilon * f / cap) when
+// f units are routed over an edge; a routing step sends every pending demand
+// of one source along its shortest-path tree, scaled so that no edge gets
+// more than its capacity. Lengths are kept as len * exp(logScale) so that
+// small epsilons do not underflow.
+MultiCommodityFlow::MultiCommodityFlow(const Graph &graph, const vector<Commodity> &commodities,
+                                       double epsilon)
+    : epsilon(epsilon), routing(commodities.size())
+{
+    int n = graph.n;
+    size_t k = commodities.size();
+    for (size_t j = 0; j < k; j++)
+        routing[j].demand = commodities[j].demand;
+
+    // Routing alone bounds each commodity: the throughput is at most
+    // beta = min(alone / demand) and at least beta / (commodities routed).
+    vector<Capacity> alone = singleCommodityFlows(graph, commodities);
+    vector<int> routed;
+    double beta = numeric_limits<double>::infinity();
+    for (size_t j = 0; j < k; j++)
+        if (alone[j] > 0)
+        {
+            routed.push_back(j);
+            beta = min(beta, (double)alone[j] / commodities[j].demand);
+        }
+    if (routed.empty())
+        return;
+    upperBound = beta;
+
+    // Positive-capacity edges as arcs grouped by tail, with every per-arc
+    // array contiguous for the Dijkstra scans.
+    vector<int> first(n + 1, 0);
+    for (const auto &e : graph.edges)
+        if (get<2>(e) > 0)
+            first[get<0>(e) + 1]++;
+    for (int v = 0; v < n; v++)
+        first[v + 1] += first[v];
+    int arcs = first[n];
+    vector<int> arcEdge(arcs), tail(arcs), head(arcs);
+    vector<double> cap(arcs);
+    {
+        vector<int> fill(first.begin(), first.end() - 1);
+        for (size_t i = 0; i < graph.edges.size(); i++)
+            if (get<2>(graph.edges[i]) > 0)
+            {
+                int a = fill[get<0>(graph.edges[i])]++;
+                arcEdge[a] = i;
+                tail[a] = get<0>(graph.edges[i]);
+                head[a] = get<1>(graph.edges[i]);
+                cap[a] = get<2>(graph.edges[i]);
+            }
+    }
+    vector<double> len(arcs), total(arcs, 0), load(arcs, 0);
+    for (int a = 0; a < arcs; a++)
+        len[a] = 1 / cap[a];
+    // D = sum(len * cap) * exp(logScale); Garg-Koenemann stop at D >= 1.
+    double lengthSum = arcs;
+    double logScale = -log(max(arcs, 2) / (1 - epsilon)) / epsilon;
+
+    // Demands are scaled so that the optimum lies in [1, routed.size()];
+    // doubling them whenever `limit` phases pass keeps the phase count
+    // logarithmic in the number of commodities.
+    vector<double> demand(k, 0), remaining(k, 0);
+    for (int j : routed)
+        demand[j] = commodities[j].demand * beta / routed.size();
+    long long limit = 2 * (long long)ceil(-logScale / log1p(epsilon));
+
+    stable_sort(routed.begin(), routed.end(),
+                [&](int a, int b) { return commodities[a].src < commodities[b].src; });
+    vector<unordered_map<int, double>> arcFlow(k);
+    vector<double> dist(n, numeric_limits<double>::infinity()), need(n, 0);
+    vector<int> parent(n, -1), reached, order, treeArcs;
+    vector<char> settled(n, 0), target(n, 0);
+    vector<pair<double, int>> heap;
+
+    // Shortest-path tree from s, grown until `targets` marked nodes are
+    // settled; order lists the settled nodes.
+    auto dijkstra = [&](int s, int targets) {
+        for (int v : reached)
+        {
+            dist[v] = numeric_limits<double>::infinity();
+            settled[v] = 0;
+        }
+        reached.assign(1, s);
+        order.clear();
+        heap.assign(1, {0.0, s});
+        dist[s] = 0;
+        while (targets > 0)
+        {
+            pop_heap(heap.begin(), heap.end(), greater<pair<double, int>>());
+            int v = heap.back().second;
+            heap.pop_back();
+            if (settled[v])
+                continue;
+            settled[v] = 1;
+            order.push_back(v);
+            targets -= target[v];
+            for (int a = first[v]; a < first[v + 1]; a++)
+            {
+                int w = head[a];
+                double d = dist[v] + len[a];
+                if (d < dist[w])
+                {
+                    if (dist[w] == numeric_limits<double>::infinity())
+                        reached.push_back(w);
+                    dist[w] = d;
+                    parent[w] = a;
+                    heap.emplace_back(d, w);
+                    push_heap(heap.begin(), heap.end(), greater<pair<double, int>>());
+                }
+            }
+        }
+    };
+
+    // One routing step for the commodities routed[from, to), which share a
+    // source; returns false once D reaches 1.
+    double dualSum = 0; // sum of demand * shortest distance this phase
+    auto step = [&](size_t from, size_t to, bool firstStep) {
+        if (log(lengthSum) + logScale >= 0)
+            return false;
+        int s = commodities[routed[from]].src, targets = 0;
+        for (size_t i = from; i < to; i++)
+        {
+            int t = commodities[routed[i]].sink;
+            if (remaining[routed[i]] > 0 && !target[t])
+            {
+                target[t] = 1;
+                targets++;
+            }
+        }
+        dijkstra(s, targets);
+        stats.augmentations++;
+        for (size_t i = from; i < to; i++)
+        {
+            int j = routed[i], t = commodities[j].sink;
+            target[t] = 0;
+            need[t] += remaining[j];
+            if (firstStep)
+                dualSum += commodities[j].demand * dist[t];
+        }
+        // Tree loads, summed up from the leaves; scale so none exceeds its
+        // edge's capacity.
+        treeArcs.clear();
+        double scale = 1;
+        for (size_t i = order.size(); i-- > 1;)
+        {
+            int v = order[i];
+            if (need[v] == 0)
+                continue;
+            int a = parent[v];
+            load[a] = need[v];
+            need[tail[a]] += need[v];
+            need[v] = 0;
+            treeArcs.push_back(a);
+            scale = min(scale, cap[a] / load[a]);
+        }
+        need[s] = 0;
+        for (size_t i = from; i < to; i++)
+        {
+            int j = routed[i];
+            double f = scale < 1 ? scale * remaining[j] : remaining[j];
+            if (f == 0)
+                continue;
+            for (int v = commodities[j].sink; v != s; v = tail[parent[v]])
+                arcFlow[j][parent[v]] += f;
+            routing[j].flow += f;
+            remaining[j] = scale < 1 ? remaining[j] - f : 0;
+        }
+        for (int a : treeArcs)
+        {
+            double f = scale * load[a];
+            total[a] += f;
+            lengthSum += epsilon * f * len[a];
+            len[a] *= 1 + epsilon * f / cap[a];
+        }
+        return true;
+    };
+
+    vector<size_t> groups; // starts of the runs of routed with one source
+    for (size_t i = 0; i < routed.size(); i++)
+        if (i == 0 || commodities[routed[i]].src != commodities[routed[i - 1]].src)
+            groups.push_back(i);
+    groups.push_back(routed.size());
+
+    // Largest edge load over capacity; the flow divided by it is feasible.
+    auto congestion = [&]() {
+        double worst = 0;
+        for (int a = 0; a < arcs; a++)
+            worst = max(worst, total[a] / cap[a]);
+        return worst;
+    };
+    auto lowerBound = [&](double rho) {
+        double worst = numeric_limits<double>::infinity();
+        for (int j : routed)
+            worst = min(worst, routing[j].flow / (commodities[j].demand * rho));
+        return worst;
+    };
+
+    for (long long phase = 1;; phase++)
+    {
+        // Rescaling between phases keeps lengths in double range.
+        if (lengthSum > 1e100)
+        {
+            for (double &l : len)
+                l /= lengthSum;
+            logScale += log(lengthSum);
+            lengthSum = 1;
+        }
+        dualSum = 0;
+        bool stopped = false;
+        for (size_t g = 0; g + 1 < groups.size() && !stopped; g++)
+        {
+            for (size_t i = groups[g]; i < groups[g + 1]; i++)
+                remaining[routed[i]] = demand[routed[i]];
+            bool firstStep = true, left = true;
+            while (left && !stopped)
+            {
+                stopped = !step(groups[g], groups[g + 1], firstStep);
+                firstStep = false;
+                left = false;
+                for (size_t i = groups[g]; i < groups[g + 1]; i++)
+                    left |= remaining[routed[i]] > 0;
+            }
+        }
+        if (stopped)
+            break;
+        stats.phases++;
+        // Lengths only grow, so each distance above is at most its value
+        // under the final lengths, and D / dualSum still bounds the optimum.
+        upperBound = min(upperBound, lengthSum / dualSum);
+        double lower = lowerBound(congestion());
+        if (lower >= (1 - epsilon) * upperBound)
+            break;
+        // The feasible throughput found so far is a better floor for the
+        // optimum than beta / k: each phase then routes close to it.
+        double grow = phase % limit == 0 ? 2 : 1;
+        for (int j : routed)
+            demand[j] = max(demand[j] * grow, commodities[j].demand * lower);
+    }
+
+    double rho = congestion();
+    throughput = lowerBound(rho);
+    for (int j : routed)
+    {
+        Routing &r = routing[j];
+        r.flow /= rho;
+        vector<pair<int, double>> flows;
+        for (const auto &af : arcFlow[j])
+            flows.emplace_back(arcEdge[af.first], af.second / rho);
+        sort(flows.begin(), flows.end());
+        for (const auto &ef : flows)
+        {
+            r.edges.push_back(ef.first);
+            r.flows.push_back(ef.second);
+        }
+    }
+}
+
+void runMultiCommodity(const Graph &graph, const vector<Commodity> &commodities, double epsilon,
+                       ResultWriter &out)
+{
+    StageTimer timer;
+    MultiCommodityFlow mcf(graph, commodities, epsilon);
+    out.stats += mcf.stats;
+    out.stats.solveSeconds += timer.lap();
+
+    out.begin("Garg-Koenemann Max Concurrent Flow");
+    out.field("epsilon", epsilon);
+    out.field("throughput", mcf.throughput);
+    out.field("upperBound", mcf.upperBound);
+    out.beginList("commodities");
+    for (size_t j = 0; j < commodities.size(); j++)
+    {
+        const MultiCommodityFlow::Routing &r = mcf.routing[j];
+        out.beginItem();
+        out.field("src", commodities[j].src);
+        out.field("sink", commodities[j].sink);
+        out.field("demand", r.demand);
+        out.field("flow", r.flow);
+        out.array("edges", r.edges);
+        out.array("flows", r.flows);
+    }
+    out.endList();
+    out.end();
+}
+
+/*
+TC Analysis:
+  - One Dinic max flow per commodity to scale the demands.
+  - Each phase routes every source's demands in a few tree steps; a step is
+    one Dijkstra, O(E log V), plus the length of each routed path. Phases
+    are O(epsilon^-2 log E) per doubling and O(log k) doublings, for k
+    commodities, in the worst case; the bound check usually ends it sooner.
+SC Analysis:
+  - O(V + E) for lengths, loads and the Dijkstra state, plus one entry per
+    edge each commodity uses.
+*/
@@ -0,0 +1,49 @@
+#ifndef MULTI_COMMODITY_H
+#define MULTI_COMMODITY_H
+
+#include "graph.h"
+#include "result_writer.h"
+#include <vector>
+using namespace std;
+
+// Copy of graph with a super source (node n) and super sink (node n + 1)
+// appended, joined to every source and sink by an edge carrying its supply
+// or demand. Those edges come after the input edges, sources first, so input
+// edge indices are unchanged. An unlimited terminal gets the total capacity
+// of its node's outgoing (or incoming) edges, which never binds.
+Graph superTerminalGraph(const Graph &graph, const Terminals &terminals);
+
+// Maximum concurrent multi-commodity flow: the largest throughput such that
+// every commodity can send throughput x its demand at once without exceeding
+// any edge capacity. Garg-Koenemann approximation with Karakostas' grouping
+// of commodities by source, so a routing step costs one Dijkstra per source
+// however many commodities share it. Edges are directed.
+struct MultiCommodityFlow
+{
+    // Flow of one commodity on the edges it uses, in edge order.
+    struct Routing
+    {
+        Capacity demand;
+        double flow = 0;
+        vector<int> edges;
+        vector<double> flows;
+    };
+
+    double epsilon;
+    // Feasible throughput found, and an upper bound on the optimum from the
+    // final edge lengths; the algorithm stops once they are within a
+    // (1 - epsilon) factor, or at the Garg-Koenemann limit.
+    double throughput = 0, upperBound = 0;
+    vector<Routing> routing; // per commodity, in input order
+    SolverStats stats;
+
+    // Commodities whose sink cannot be reached from their source get no
+    // flow and are left out of the throughput, as are zero demands.
+    MultiCommodityFlow(const Graph &graph, const vector<Commodity> &commodities, double epsilon);
+};
+
+// Writes the throughput and every commodity's routing.
+void runMultiCommodity(const Graph &graph, const vector<Commodity> &commodities, double epsilon,
+                       ResultWriter &out);
+
+#endif // MULTI_COMMODITY_H
@@ -0,0 +1,280 @@
+#include "packet_sim.h"
+#include "dinic.h"
+#include "event_queue.h"
+#include "residual_graph.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+enum EventKind : uint32_t
+{
+    INJECT, // next packet enters at the source
+    ARRIVE, // packet id reaches its node
+    DEPART  // link id finished sending its head packet
+};
+
+// Latencies go into log-linear buckets: exact below 64 ns, then 32 buckets
+// per power of two.
+static const int SUB_BUCKETS = 32;
+static const int HISTOGRAM_SIZE = 2 * SUB_BUCKETS + 59 * SUB_BUCKETS;
+
+static int histogramBucket(uint64_t v)
+{
+    if (v < 2 * SUB_BUCKETS)
+        return (int)v;
+    int shift = highestBit(v) - 5;
+    return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + (int)(v >> shift) - SUB_BUCKETS;
+}
+
+// Midpoint of bucket i.
+static uint64_t histogramValue(int i)
+{
+    if (i < 2 * SUB_BUCKETS)
+        return i;
+    int shift = (i - 2 * SUB_BUCKETS) / SUB_BUCKETS + 1;
+    uint64_t top = (i - 2 * SUB_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+    return (top << shift) + (1ull << (shift - 1));
+}
+
+PacketSimulator::PacketSimulator(const Graph &graph, const vector<Capacity> &edgeFlows,
+                                 const SimulationConfig &config)
+    : busyTime(graph.edges.size(), 0), linkDrops(graph.edges.size(), 0),
+      maxQueue(graph.edges.size(), 0), graph(graph), config(config), first(graph.n + 1, 0),
+      histogram(HISTOGRAM_SIZE, 0)
+{
+    size_t m = graph.edges.size();
+    links.resize(m);
+    for (size_t i = 0; i < m; i++)
+    {
+        Capacity rate = get<2>(graph.edges[i]);
+        Link &l = links[i];
+        l.head = l.tail = -1;
+        l.length = 0;
+        l.serialize = rate > 0 ? max<uint64_t>(1, llround(config.packetBytes * 8e9 / rate)) : 0;
+        l.propagate = graph.edgeCost(i) * 1000;
+    }
+
+    // Only edges carrying flow forward packets.
+    for (size_t i = 0; i < m; i++)
+        if (edgeFlows[i] > 0)
+            first[get<0>(graph.edges[i]) + 1]++;
+    for (int v = 0; v < graph.n; v++)
+        first[v + 1] += first[v];
+    choiceEdge.resize(first[graph.n]);
+    choiceWeight.resize(first[graph.n]);
+    vector<int> fill(first.begin(), first.end() - 1);
+    for (size_t i = 0; i < m; i++)
+        if (edgeFlows[i] > 0)
+        {
+            int u = get<0>(graph.edges[i]), c = fill[u]++;
+            choiceEdge[c] = i;
+            choiceWeight[c] = (c > first[u] ? choiceWeight[c - 1] : 0) + edgeFlows[i];
+        }
+
+    // The source's outflow is the max flow.
+    Capacity maxFlow = 0;
+    if (graph.n > 0 && first[graph.src + 1] > first[graph.src])
+        maxFlow = choiceWeight[first[graph.src + 1] - 1];
+    offeredBps = config.load * maxFlow;
+    if (offeredBps > 0)
+        meanGap = config.packetBytes * 8e9 / offeredBps;
+}
+
+int PacketSimulator::allocate()
+{
+    if (freePacket < 0)
+    {
+        pool.push_back(Packet());
+        return (int)pool.size() - 1;
+    }
+    int p = freePacket;
+    freePacket = pool[p].next;
+    return p;
+}
+
+void PacketSimulator::release(int p)
+{
+    pool[p].next = freePacket;
+    freePacket = p;
+}
+
+void PacketSimulator::record(uint64_t latency)
+{
+    histogram[histogramBucket(latency)]++;
+    latencySum += latency;
+    latencyMax = max(latencyMax, latency);
+}
+
+uint64_t PacketSimulator::latency(double q) const
+{
+    if (delivered == 0)
+        return 0;
+    long long rank = max(1ll, (long long)ceil(q * delivered)), seen = 0;
+    for (int i = 0; i < HISTOGRAM_SIZE; i++)
+    {
+        seen += histogram[i];
+        if (seen >= rank)
+            return min(histogramValue(i), latencyMax);
+    }
+    return latencyMax;
+}
+
+void PacketSimulator::run()
+{
+    if (meanGap <= 0 || config.packets <= 0)
+        return;
+    EventQueue queue;
+    // SplitMix64: one multiply-xorshift round per draw, much cheaper than
+    // mt19937 on the per-hop path.
+    uint64_t state = config.seed;
+    auto uniform = [&]() {
+        uint64_t z = state += 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return ((z ^ (z >> 31)) >> 11) * (1.0 / (1ull << 53));
+    };
+
+    // Sends the packet on at node v, or finishes it at the sink.
+    auto forward = [&](int p, int v, uint64_t now) {
+        Packet &packet = pool[p];
+        if (v == graph.sink)
+        {
+            delivered++;
+            record(now - packet.born);
+            release(p);
+            return;
+        }
+        int from = first[v], to = first[v + 1];
+        if (from == to || packet.hops >= config.hopLimit)
+        {
+            expired++;
+            release(p);
+            return;
+        }
+        int c = from;
+        if (to - from > 1)
+        {
+            Capacity pick = (Capacity)(uniform() * choiceWeight[to - 1]);
+            c = upper_bound(choiceWeight.begin() + from, choiceWeight.begin() + to, pick) - choiceWeight.begin();
+            c = min(c, to - 1);
+        }
+        int e = choiceEdge[c];
+        Link &l = links[e];
+        if (l.length > config.queuePackets)
+        {
+            dropped++;
+            linkDrops[e]++;
+            release(p);
+            return;
+        }
+        packet.hops++;
+        packet.next = -1;
+        if (l.length++ == 0)
+        {
+            l.head = l.tail = p;
+            busyTime[e] += l.serialize;
+            queue.push({now + l.serialize, DEPART, (uint32_t)e});
+        }
+        else
+        {
+            pool[l.tail].next = p;
+            l.tail = p;
+        }
+        maxQueue[e] = max(maxQueue[e], l.length);
+    };
+
+    queue.push({0, INJECT, 0});
+    while (!queue.empty())
+    {
+        Event ev = queue.pop();
+        uint64_t now = ev.time;
+        events++;
+        if (ev.kind == INJECT)
+        {
+            int p = allocate();
+            pool[p].born = now;
+            pool[p].hops = 0;
+            forward(p, graph.src, now);
+            if (++injected < config.packets)
+                queue.push({now + (uint64_t)llround(-log1p(-uniform()) * meanGap), INJECT, 0});
+        }
+        else if (ev.kind == ARRIVE)
+        {
+            forward(ev.id, pool[ev.id].node, now);
+        }
+        else
+        {
+            Link &l = links[ev.id];
+            int p = l.head;
+            l.head = pool[p].next;
+            if (--l.length > 0)
+            {
+                busyTime[ev.id] += l.serialize;
+                queue.push({now + l.serialize, DEPART, ev.id});
+            }
+            int v = get<1>(graph.edges[ev.id]);
+            if (l.propagate == 0)
+                forward(p, v, now);
+            else
+            {
+                pool[p].node = v;
+                queue.push({now + l.propagate, ARRIVE, (uint32_t)p});
+            }
+        }
+        endTime = now;
+    }
+}
+
+void runPacketSimulation(const Graph &graph, const SimulationConfig &config, ResultWriter &out)
+{
+    StageTimer timer;
+    vector<Capacity> flows(graph.edges.size(), 0);
+    if (graph.src != graph.sink)
+    {
+        ResidualGraph<Capacity> rg(graph);
+        Dinic<Capacity> dinic(rg);
+        dinic.maxFlow(graph.src, graph.sink);
+        for (size_t i = 0; i < flows.size(); i++)
+            flows[i] = rg.edgeFlow(i);
+    }
+    // The flow is the simulation's input.
+    out.stats.buildSeconds += timer.lap();
+    PacketSimulator sim(graph, flows, config);
+    sim.run();
+    out.stats.solveSeconds += timer.lap();
+
+    double seconds = sim.endTime * 1e-9;
+    vector<double> utilization(graph.edges.size(), 0);
+    if (sim.endTime > 0)
+        for (size_t i = 0; i < utilization.size(); i++)
+            utilization[i] = (double)sim.busyTime[i] / sim.endTime;
+    out.begin("Packet Simulation");
+    out.field("offeredBps", sim.offeredBps);
+    out.field("injected", sim.injected);
+    out.field("delivered", sim.delivered);
+    out.field("dropped", sim.dropped);
+    out.field("expired", sim.expired);
+    out.field("throughputBps", seconds > 0 ? sim.delivered * config.packetBytes * 8.0 / seconds : 0.0);
+    out.field("simulatedSeconds", seconds);
+    out.field("events", sim.events);
+    out.field("latencyMean", sim.meanLatency() * 1e-9);
+    out.field("latencyP50", sim.latency(0.5) * 1e-9);
+    out.field("latencyP90", sim.latency(0.9) * 1e-9);
+    out.field("latencyP99", sim.latency(0.99) * 1e-9);
+    out.field("latencyMax", sim.maxLatency() * 1e-9);
+    out.array("linkUtilization", utilization);
+    out.array("linkDrops", sim.linkDrops);
+    out.array("linkMaxQueue", sim.maxQueue);
+    out.end();
+}
+
+/*
+TC Analysis:
+  - One Dinic max flow, O(V^2 * E).
+  - Each hop of a packet is at most three events (arrival, departure, and
+    the injection for new packets), each O(log deg) for the forwarding
+    choice plus O(1) amortised in the event queue: O(packets * hops).
+SC Analysis:
+  - O(V + E) for links and forwarding tables, plus one pooled packet per
+    packet in flight and the fixed-size latency histogram.
+*/
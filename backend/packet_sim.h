@@ -0,0 +1,84 @@
+#ifndef PACKET_SIM_H
+#define PACKET_SIM_H
+
+#include "graph.h"
+#include "result_writer.h"
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+// Times are in nanoseconds. Capacities are link rates in bits per second
+// and edge costs are propagation delays in microseconds.
+struct SimulationConfig
+{
+    long long packets = 1000000; // injected at the source
+    int packetBytes = 1500;
+    double load = 0.9; // injection rate as a fraction of the max flow
+    int queuePackets = 64; // per-link buffer behind the packet being sent
+    int hopLimit = 255;
+    uint64_t seed = 1;
+};
+
+// Discrete-event packet simulation over a solved flow. Packets arrive at the
+// source as a Poisson stream and each node forwards a packet on one of its
+// outgoing edges, chosen with probability proportional to the edge's flow.
+// Every link is a FIFO queue drained at its rate: a packet takes
+// packetBytes * 8 / rate to serialize plus the propagation delay, and is
+// dropped if the queue is full when it arrives.
+class PacketSimulator
+{
+public:
+    PacketSimulator(const Graph &graph, const vector<Capacity> &edgeFlows, const SimulationConfig &config);
+
+    void run();
+
+    long long injected = 0, delivered = 0, dropped = 0, expired = 0;
+    long long events = 0;
+    uint64_t endTime = 0; // time of the last event
+    double offeredBps = 0;
+    vector<uint64_t> busyTime;   // per edge, time spent sending
+    vector<long long> linkDrops; // per edge
+    vector<int> maxQueue;        // per edge, longest queue seen
+
+    // Delivery latency quantile q in [0, 1], within 1/64 of the true value.
+    uint64_t latency(double q) const;
+    double meanLatency() const { return delivered ? (double)latencySum / delivered : 0; }
+    uint64_t maxLatency() const { return latencyMax; }
+
+private:
+    struct Packet
+    {
+        uint64_t born;
+        int node, hops;
+        int next; // next packet in the same link queue, or in the free list
+    };
+    struct Link
+    {
+        int head, tail; // packet queue; head is being sent
+        int length;
+        uint64_t serialize, propagate;
+    };
+
+    const Graph &graph;
+    SimulationConfig config;
+    vector<Link> links;
+    // Forwarding choices of each node: edges first[v] .. first[v + 1] - 1,
+    // with cumulative flow weights.
+    vector<int> first, choiceEdge;
+    vector<Capacity> choiceWeight;
+    vector<Packet> pool;
+    int freePacket = -1;
+    double meanGap = 0; // between injections
+    vector<long long> histogram;
+    uint64_t latencySum = 0, latencyMax = 0;
+
+    int allocate();
+    void release(int p);
+    void record(uint64_t latency);
+};
+
+// Solves the max flow with Dinic, simulates packets over it and writes
+// delivery counts, latency percentiles and per-link utilization.
+void runPacketSimulation(const Graph &graph, const SimulationConfig &config, ResultWriter &out);
+
+#endif // PACKET_SIM_H
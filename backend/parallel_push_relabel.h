@@ -0,0 +1,16 @@
+#ifndef PARALLEL_PUSH_RELABEL_H
+#define PARALLEL_PUSH_RELABEL_H
+
+#include "graph.h"
+#include "result_writer.h"
+using namespace std;
+
+// Synchronous parallel push-relabel on `threads` workers. Each round pushes
+// from every active node at once, then applies the reverse-arc credits, then
+// relabels all stuck nodes against the labels from the start of the round,
+// so no arc or label is ever written by two threads in the same step.
+// Global relabels are parallel BFS passes. Honours out.cutOnly like
+// runGoldbergTarjan.
+void runParallelPushRelabel(const Graph &graph, ResultWriter &out, int threads);
+
+#endif // PARALLEL_PUSH_RELABEL_H
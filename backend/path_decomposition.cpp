@@ -0,0 +1,105 @@
+#include "path_decomposition.h"
+#include <algorithm>
+using namespace std;
+
+template <typename Cap>
+void decomposePaths(const Graph &graph, vector<Cap> &flows, int s, int t,
+                    const function<void(Cap, const vector<int> &)> &emit)
+{
+    int n = graph.n;
+    if (s == t || n == 0)
+        return;
+    // Flow-carrying edges grouped by tail; next[v] moves past the ones that
+    // have been emptied, so each edge is skipped once in all.
+    vector<int> first(n + 1, 0), out;
+    for (size_t i = 0; i < flows.size(); i++)
+        if (flows[i] > 0)
+            first[get<0>(graph.edges[i]) + 1]++;
+    for (int v = 0; v < n; v++)
+        first[v + 1] += first[v];
+    out.resize(first[n]);
+    vector<int> next(first.begin(), first.end() - 1);
+    for (size_t i = 0; i < flows.size(); i++)
+        if (flows[i] > 0)
+            out[next[get<0>(graph.edges[i])]++] = i;
+    copy(first.begin(), first.end() - 1, next.begin());
+    auto tail = [&](int e) { return get<0>(graph.edges[e]); };
+    auto head = [&](int e) { return get<1>(graph.edges[e]); };
+
+    vector<int> path;
+    // Per node on the walk, how many edges lead up to it; -1 elsewhere.
+    vector<int> depth(n, -1);
+    depth[s] = 0;
+    int v = s;
+    for (;;)
+    {
+        if (v == t)
+        {
+            Cap f = flows[path[0]];
+            for (int e : path)
+                f = min(f, flows[e]);
+            for (int e : path)
+            {
+                flows[e] -= f;
+                depth[head(e)] = -1;
+            }
+            emit(f, path);
+            path.clear();
+            v = s;
+            continue;
+        }
+        while (next[v] < first[v + 1] && !(flows[out[next[v]]] > 0))
+            next[v]++;
+        if (next[v] == first[v + 1])
+        {
+            // Out of flow at s: done. Elsewhere only rounding in floating
+            // flows leaves a node with inflow but no outflow; the edge into
+            // it is dropped.
+            if (path.empty())
+                break;
+            int e = path.back();
+            path.pop_back();
+            flows[e] = 0;
+            depth[v] = -1;
+            v = tail(e);
+            continue;
+        }
+        int e = out[next[v]], w = head(e);
+        if (depth[w] >= 0)
+        {
+            // The walk from w back to itself is a cycle: cancel it and
+            // carry on from w.
+            Cap f = flows[e];
+            for (size_t i = depth[w]; i < path.size(); i++)
+                f = min(f, flows[path[i]]);
+            flows[e] -= f;
+            for (size_t i = depth[w]; i < path.size(); i++)
+                flows[path[i]] -= f;
+            while ((int)path.size() > depth[w])
+            {
+                depth[head(path.back())] = -1;
+                path.pop_back();
+            }
+            v = w;
+            continue;
+        }
+        path.push_back(e);
+        depth[w] = path.size();
+        v = w;
+    }
+}
+
+template void decomposePaths(const Graph &graph, vector<int> &flows, int s, int t,
+                             const function<void(int, const vector<int> &)> &emit);
+template void decomposePaths(const Graph &graph, vector<long long> &flows, int s, int t,
+                             const function<void(long long, const vector<int> &)> &emit);
+template void decomposePaths(const Graph &graph, vector<double> &flows, int s, int t,
+                             const function<void(double, const vector<int> &)> &emit);
+
+/*
+TC Analysis:
+  - Every path or cancelled cycle empties an edge and costs O(its length);
+    skipping emptied edges is O(E) in all. Total O(E * path length).
+SC Analysis:
+  - O(V + E) for the grouped edges and the walk.
+*/
@@ -0,0 +1,22 @@
+#ifndef PATH_DECOMPOSITION_H
+#define PATH_DECOMPOSITION_H
+
+#include "graph.h"
+#include <functional>
+#include <vector>
+using namespace std;
+
+// Splits an s-t flow into weighted s-t paths. flows holds the flow on every
+// edge of graph and is used up. The walk follows flow-carrying edges from s
+// until it reaches t, which yields a path, or a node already on the walk,
+// which closes a cycle that is cancelled instead of reported. Flow on cycles
+// never reached from s is ignored. Each path or cycle empties at least one
+// edge, so there are at most E of each and the walk costs
+// O(E * path length). emit is called once per path with its flow and its
+// edge indices from s to t; the edge list is only valid during the call.
+// Cap is instantiated for int, long long and double.
+template <typename Cap>
+void decomposePaths(const Graph &graph, vector<Cap> &flows, int s, int t,
+                    const function<void(Cap, const vector<int> &)> &emit);
+
+#endif // PATH_DECOMPOSITION_H
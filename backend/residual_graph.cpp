@@ -0,0 +1,84 @@
+#include "residual_graph.h"
+using namespace std;
+
+template <typename Cap>
+ResidualGraph<Cap>::ResidualGraph(const Graph &graph, pmr::memory_resource *memory)
+    : n(graph.n), first(graph.n + 1, 0, memory), head(memory), rev(memory), cap(memory),
+      orig(memory), edgeArc(memory)
+{
+    int m = graph.edges.size();
+    // Count arcs per node, then prefix-sum into offsets.
+    for (auto &edge : graph.edges)
+    {
+        first[get<0>(edge) + 1]++;
+        first[get<1>(edge) + 1]++;
+    }
+    for (int u = 0; u < n; u++)
+        first[u + 1] += first[u];
+
+    head.resize(2 * m);
+    rev.resize(2 * m);
+    cap.resize(2 * m);
+    edgeArc.resize(m);
+    pmr::vector<int> pos(first.begin(), first.end() - 1, memory);
+    for (int i = 0; i < m; i++)
+    {
+        int u, v;
+        Capacity c;
+        tie(u, v, c) = graph.edges[i];
+        int a = pos[u]++;
+        int b = pos[v]++;
+        head[a] = v;
+        head[b] = u;
+        rev[a] = b;
+        rev[b] = a;
+        cap[a] = (Cap)c;
+        cap[b] = 0;
+        edgeArc[i] = a;
+    }
+    orig = cap;
+}
+
+// The sink side is every node that can still reach t, found by a reverse BFS
+// over residual arcs. Unlike forward reachability from s this is also exact
+// for a maximum preflow, whose leftover excess sits on the source side.
+template <typename Cap>
+vector<int> ResidualGraph<Cap>::cutEdges(int s, int t) const
+{
+    vector<int> edges;
+    if (s == t)
+        return edges;
+    vector<char> sinkSide(n, 0);
+    vector<int> queue{t};
+    sinkSide[t] = 1;
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+        int v = queue[i];
+        for (int a = first[v]; a < first[v + 1]; a++)
+        {
+            int w = head[a];
+            if (!sinkSide[w] && cap[rev[a]] > 0)
+            {
+                sinkSide[w] = 1;
+                queue.push_back(w);
+            }
+        }
+    }
+    for (size_t i = 0; i < edgeArc.size(); i++)
+    {
+        int a = edgeArc[i];
+        if (orig[a] > 0 && !sinkSide[tail(a)] && sinkSide[head[a]])
+            edges.push_back(i);
+    }
+    return edges;
+}
+
+template struct ResidualGraph<int>;
+template struct ResidualGraph<long long>;
+template struct ResidualGraph<double>;
+
+/*
+SC Analysis:
+  - O(V + E): 2E arcs, V + 1 offsets and one arc handle per edge.
+  - cutEdges is one O(V + E) BFS.
+*/
@@ -0,0 +1,50 @@
+#ifndef RESIDUAL_GRAPH_H
+#define RESIDUAL_GRAPH_H
+
+#include "graph.h"
+#include <memory_resource>
+#include <vector>
+using namespace std;
+
+// Residual graph in compressed-sparse-row (CSR) form, shared by all solvers.
+// The arcs leaving node u are first[u] .. first[u + 1] - 1. Every input edge
+// (u, v, cap) becomes a forward arc at u and a zero-capacity reverse arc at v,
+// linked through rev, so memory is O(V + E) instead of an n x n matrix.
+// Cap is the capacity type (instantiated for int, long long and double).
+// The arrays come from `memory`; solvers allocate their own working arrays
+// from the same resource (see Workspace).
+template <typename Cap>
+struct ResidualGraph
+{
+    int n;
+    pmr::vector<int> first; // n + 1 offsets into the arc arrays
+    pmr::vector<int> head;  // target node of each arc
+    pmr::vector<int> rev;   // index of the paired reverse arc
+    pmr::vector<Cap> cap;   // residual capacity
+    pmr::vector<Cap> orig;  // capacity before solving (0 for reverse arcs)
+    pmr::vector<int> edgeArc; // forward arc of each input edge, in input order
+
+    ResidualGraph(const Graph &graph, pmr::memory_resource *memory = pmr::get_default_resource());
+
+    pmr::memory_resource *memory() const { return first.get_allocator().resource(); }
+
+    int arcCount() const { return (int)head.size(); }
+    int tail(int a) const { return head[rev[a]]; }
+    Cap flow(int a) const { return orig[a] - cap[a]; }
+
+    // Sends f units along arc a and credits its reverse arc.
+    void push(int a, Cap f)
+    {
+        cap[a] -= f;
+        cap[rev[a]] += f;
+    }
+
+    // Flow on input edge i; O(1) and exact for parallel edges.
+    Cap edgeFlow(int i) const { return flow(edgeArc[i]); }
+
+    // Input edges (by index) crossing the minimum s-t cut, found with one
+    // residual BFS over the final flow; empty if s == t.
+    vector<int> cutEdges(int s, int t) const;
+};
+
+#endif // RESIDUAL_GRAPH_H
@@ -0,0 +1,193 @@
+#include "result_writer.h"
+#include <charconv>
+#include <cstring>
+using namespace std;
+
+// Flushed once this much output has accumulated.
+static const size_t BUFFER_SIZE = 1 << 20;
+
+ResultWriter::ResultWriter(ostream &out, OutputFormat format)
+    : format(format), out(out), buf(BUFFER_SIZE)
+{
+}
+
+ResultWriter::~ResultWriter()
+{
+    flush();
+}
+
+void ResultWriter::flush()
+{
+    out.write(buf.data(), used);
+    used = 0;
+}
+
+void ResultWriter::raw(const char *s)
+{
+    size_t len = strlen(s);
+    reserve(len);
+    memcpy(buf.data() + used, s, len);
+    used += len;
+}
+
+void ResultWriter::writeKey(const char *key)
+{
+    reserve(strlen(key) + 4);
+    // In NDJSON, fields after the edge lines start a new trailing object.
+    put(objectOpen ? ',' : '{');
+    objectOpen = true;
+    put('"');
+    raw(key);
+    raw("\":");
+}
+
+void ResultWriter::integer(long long value)
+{
+    reserve(24);
+    used = to_chars(buf.data() + used, buf.data() + buf.size(), value).ptr - buf.data();
+}
+
+void ResultWriter::real(double value)
+{
+    reserve(32);
+    used = to_chars(buf.data() + used, buf.data() + buf.size(), value).ptr - buf.data();
+}
+
+void ResultWriter::quoted(const char *s)
+{
+    static const char HEX[] = "0123456789abcdef";
+    reserve(1);
+    put('"');
+    for (; *s; s++)
+    {
+        unsigned char c = *s;
+        reserve(6);
+        if (c == '"' || c == '\\')
+        {
+            put('\\');
+            put(c);
+        }
+        else if (c < 0x20)
+        {
+            raw("\\u00");
+            put(HEX[c >> 4]);
+            put(HEX[c & 15]);
+        }
+        else
+        {
+            put(c);
+        }
+    }
+    reserve(1);
+    put('"');
+}
+
+void ResultWriter::begin(const string &algorithm)
+{
+    outputTimer.lap();
+    objectOpen = false;
+    writeKey("algorithm");
+    quoted(algorithm.c_str());
+}
+
+void ResultWriter::field(const char *key, const char *value)
+{
+    writeKey(key);
+    quoted(value);
+}
+
+void ResultWriter::beginList(const char *key)
+{
+    firstItem = true;
+    if (format == OutputFormat::NDJSON)
+    {
+        if (objectOpen)
+            raw("}\n");
+        objectOpen = false;
+        return;
+    }
+    writeKey(key);
+    raw("[");
+    objectOpen = false;
+}
+
+void ResultWriter::beginItem()
+{
+    // Each item's first field opens it.
+    if (objectOpen)
+        raw(format == OutputFormat::NDJSON ? "}\n" : "}");
+    if (!firstItem && format == OutputFormat::JSON)
+        raw(",");
+    firstItem = false;
+    objectOpen = false;
+}
+
+void ResultWriter::endList()
+{
+    if (objectOpen)
+        raw(format == OutputFormat::NDJSON ? "}\n" : "}");
+    // In JSON the enclosing object is still open.
+    objectOpen = format == OutputFormat::JSON;
+    if (format == OutputFormat::JSON)
+        raw("]");
+}
+
+void ResultWriter::beginEdgeFlows()
+{
+    firstItem = true;
+    if (format == OutputFormat::NDJSON)
+    {
+        raw("}\n");
+        objectOpen = false;
+        return;
+    }
+    writeKey("edgeFlows");
+    raw("[");
+}
+
+void ResultWriter::endEdgeFlows()
+{
+    if (format == OutputFormat::JSON)
+        raw("]");
+}
+
+void ResultWriter::statsFields(const SolverStats &s)
+{
+    field("parseSeconds", s.parseSeconds);
+    field("buildSeconds", s.buildSeconds);
+    field("solveSeconds", s.solveSeconds);
+    field("outputSeconds", s.outputSeconds);
+    field("phases", s.phases);
+    field("augmentations", s.augmentations);
+    field("arcScans", s.arcScans);
+    field("pushes", s.pushes);
+    field("relabels", s.relabels);
+    field("gaps", s.gaps);
+    field("globalRelabels", s.globalRelabels);
+    field("orphans", s.orphans);
+    field("adoptions", s.adoptions);
+    field("bellmanFordRounds", s.bellmanFordRounds);
+    field("allocations", s.allocations);
+    field("heapAllocations", s.heapAllocations);
+}
+
+void ResultWriter::end()
+{
+    stats.outputSeconds += outputTimer.lap();
+    if (workspace)
+    {
+        stats.allocations = workspace->allocations();
+        stats.heapAllocations = workspace->heapAllocations();
+    }
+    if (reportStats)
+    {
+        // A nested object: after its key, the first inner field opens it.
+        writeKey("stats");
+        objectOpen = false;
+        statsFields(stats);
+        raw("}");
+    }
+    if (objectOpen)
+        raw(format == OutputFormat::NDJSON ? "}\n" : "}");
+    objectOpen = false;
+}
@@ -0,0 +1,235 @@
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include "graph.h"
+#include "graph_reduction.h"
+#include "path_decomposition.h"
+#include "residual_graph.h"
+#include "solver_stats.h"
+#include "workspace.h"
+#include <algorithm>
+#include <memory_resource>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+// JSON is the single-object format the frontend parses. NDJSON puts the
+// scalar fields on the first line and each edge flow on its own line as a
+// compact [u, v, cap, flow] array, for callers that stream large results.
+enum class OutputFormat
+{
+    JSON,
+    NDJSON
+};
+
+// Buffered result emitter shared by all solvers. Numbers are formatted with
+// to_chars into one reusable buffer that is flushed to the stream in large
+// chunks, so a result never has to be assembled in memory.
+class ResultWriter
+{
+public:
+    ResultWriter(ostream &out, OutputFormat format = OutputFormat::JSON);
+    ~ResultWriter();
+
+    void begin(const string &algorithm);
+    template <typename T>
+    void field(const char *key, T value)
+    {
+        writeKey(key);
+        number(value);
+    }
+    void field(const char *key, const char *value);
+    template <typename T>
+    void array(const char *key, const vector<T> &values)
+    {
+        writeKey(key);
+        raw("[");
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            if (i > 0)
+                raw(",");
+            number(values[i]);
+        }
+        raw("]");
+    }
+    // A list of objects: beginItem() starts each one, then its fields are
+    // written as usual. In NDJSON every item is a line of its own.
+    void beginList(const char *key);
+    void beginItem();
+    void endList();
+    void beginEdgeFlows();
+    template <typename T>
+    void edgeFlow(int u, int v, Capacity cap, T flow)
+    {
+        reserve(128);
+        if (format == OutputFormat::NDJSON)
+        {
+            put('[');
+            number(u);
+            put(',');
+            number(v);
+            put(',');
+            number(cap);
+            put(',');
+            number(flow);
+            raw("]\n");
+            return;
+        }
+        if (!firstItem)
+            put(',');
+        firstItem = false;
+        raw("{\"u\":");
+        number(u);
+        raw(",\"v\":");
+        number(v);
+        raw(",\"cap\":");
+        number(cap);
+        raw(",\"flow\":");
+        number(flow);
+        put('}');
+    }
+    void endEdgeFlows();
+    // Writes the whole edgeFlows section from a solved residual graph,
+    // looking up each input edge through its arc handle. Skipped in cut-only
+    // mode. With a reduction set, graph is the reduced graph and flows are
+    // reported on the original edges; with only `original` set, graph is a
+    // relabeled copy and node ids are taken from the original. With
+    // terminals set, the super-terminal edges are written as sourceFlows and
+    // sinkFlows instead. With paths set, the flow's path decomposition
+    // follows.
+    template <typename Cap>
+    void edgeFlows(const Graph &graph, const ResidualGraph<Cap> &rg)
+    {
+        if (cutOnly)
+            return;
+        const Graph &input = reduction ? reduction->original : original ? *original : graph;
+        vector<Cap> flows(graph.edges.size());
+        for (size_t i = 0; i < flows.size(); i++)
+            flows[i] = rg.edgeFlow(i);
+        if (reduction)
+            flows = reduction->expandFlows(flows);
+        size_t network = networkEdges(input.edges.size());
+        beginEdgeFlows();
+        for (size_t i = 0; i < network; i++)
+        {
+            int u, v;
+            Capacity cap;
+            tie(u, v, cap) = input.edges[i];
+            edgeFlow(u, v, cap, flows[i]);
+        }
+        endEdgeFlows();
+        if (terminals)
+        {
+            auto split = flows.begin() + network + terminals->sources.size();
+            array("sourceFlows", vector<Cap>(flows.begin() + network, split));
+            array("sinkFlows", vector<Cap>(split, flows.end()));
+        }
+        if (paths)
+            flowPaths(input, flows);
+    }
+    // Writes the decomposition of flows on graph into src-sink paths as a
+    // list of {flow, edges} items; flows is used up. Super-terminal edges
+    // are left off the ends of each path.
+    template <typename Cap>
+    void flowPaths(const Graph &graph, vector<Cap> &flows)
+    {
+        int trim = terminals ? 1 : 0;
+        vector<int> edges;
+        beginList("paths");
+        decomposePaths<Cap>(graph, flows, graph.src, graph.sink, [&](Cap flow, const vector<int> &path) {
+            edges.assign(path.begin() + trim, path.end() - trim);
+            beginItem();
+            field("flow", flow);
+            array("edges", edges);
+        });
+        endList();
+    }
+    // Writes the input edges crossing the minimum s-t cut as cutEdges.
+    // Super-terminal edges are left out.
+    template <typename Cap>
+    void cutEdges(const ResidualGraph<Cap> &rg, int s, int t)
+    {
+        vector<int> edges = rg.cutEdges(s, t);
+        if (reduction)
+            edges = reduction->expandCut(edges);
+        if (terminals)
+        {
+            // Reordering keeps the edges, so only a reduction changes the count.
+            size_t network = networkEdges(reduction ? reduction->original.edges.size() : rg.edgeArc.size());
+            edges.erase(remove_if(edges.begin(), edges.end(), [&](int e) { return (size_t)e >= network; }),
+                        edges.end());
+        }
+        array("cutEdges", edges);
+    }
+    // Closes the result, first appending a "stats" object if reportStats
+    // is set; output time runs from begin() to here.
+    void end();
+    void flush();
+    // Writes every counter and stage time in s as fields of the current
+    // object.
+    void statsFields(const SolverStats &s);
+
+    OutputFormat format;
+    // Report maxFlow and cutEdges only; solvers may then skip work that only
+    // per-edge flows need.
+    bool cutOnly = false;
+    // Set when the solver runs on a reduced graph (--reduce).
+    const GraphReduction *reduction = nullptr;
+    // Set when the solver runs on a relabeled copy of this graph (--reorder).
+    const Graph *original = nullptr;
+    // Append the flow's path decomposition to edgeFlows (--paths).
+    bool paths = false;
+    // Set when the input is a superTerminalGraph (--terminals): its last
+    // edges join the super source and sink to these terminals.
+    const Terminals *terminals = nullptr;
+    // Counters the solver fills while producing this result.
+    SolverStats stats;
+    // Append stats to every result (--stats).
+    bool reportStats = false;
+    // Arena for the solver's residual graph and working arrays, set by
+    // runAlgorithm to the calling thread's Workspace; null means the heap.
+    Workspace *workspace = nullptr;
+    pmr::memory_resource *memory() const
+    {
+        return workspace ? (pmr::memory_resource *)workspace : pmr::get_default_resource();
+    }
+
+private:
+    ostream &out;
+    vector<char> buf;
+    size_t used = 0;
+    bool objectOpen = false, firstItem = true;
+    StageTimer outputTimer;
+
+    // Edges before the super-terminal ones, out of total.
+    size_t networkEdges(size_t total) const
+    {
+        return terminals ? total - terminals->sources.size() - terminals->sinks.size() : total;
+    }
+    void reserve(size_t bytes)
+    {
+        if (used + bytes > buf.size())
+            flush();
+    }
+    // Callers reserve() first; used only inside already-reserved spans.
+    void put(char c) { buf[used++] = c; }
+    void raw(const char *s);
+    // Writes s as a JSON string, escaping quotes, backslashes and control
+    // characters.
+    void quoted(const char *s);
+    void writeKey(const char *key);
+    void integer(long long value);
+    void real(double value);
+    template <typename T>
+    void number(T value)
+    {
+        if constexpr (is_floating_point<T>::value)
+            real(value);
+        else
+            integer(value);
+    }
+};
+
+#endif // RESULT_WRITER_H
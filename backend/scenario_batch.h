@@ -0,0 +1,16 @@
+#ifndef SCENARIO_BATCH_H
+#define SCENARIO_BATCH_H
+
+#include "graph.h"
+#include "result_writer.h"
+#include <vector>
+using namespace std;
+
+// Solves every scenario with Dinic across `threads` workers. Each worker
+// builds one residual graph from the base graph and resets it in place per
+// scenario, so no memory is allocated per scenario. Writes one NDJSON line
+// per scenario, in scenario order.
+void runScenarioBatch(const Graph &graph, const vector<Scenario> &scenarios, int threads,
+                      ResultWriter &out);
+
+#endif // SCENARIO_BATCH_H
@@ -0,0 +1,67 @@
+#ifndef SOLVER_STATS_H
+#define SOLVER_STATS_H
+
+#include <chrono>
+using namespace std;
+
+// Operation counters a solver reports about its last run. Each solver only
+// fills the fields that apply to it.
+struct SolverStats
+{
+    long long phases = 0;        // BFS / shortest-path / refine rounds
+    long long augmentations = 0; // augmenting paths
+    long long arcScans = 0;      // residual arcs looked at by BFS
+    long long pushes = 0;
+    long long relabels = 0;
+    long long gaps = 0;           // gap-heuristic lifts
+    long long globalRelabels = 0;
+    long long orphans = 0;   // BK nodes cut from their tree
+    long long adoptions = 0; // BK orphans re-attached
+    long long bellmanFordRounds = 0; // MCMF potential initialisation
+    long long allocations = 0;     // working-memory requests
+    long long heapAllocations = 0; // of those, served by a new heap block
+    // Wall time per stage of a run.
+    double parseSeconds = 0, buildSeconds = 0, solveSeconds = 0, outputSeconds = 0;
+
+    SolverStats &operator+=(const SolverStats &o)
+    {
+        phases += o.phases;
+        augmentations += o.augmentations;
+        arcScans += o.arcScans;
+        pushes += o.pushes;
+        relabels += o.relabels;
+        gaps += o.gaps;
+        globalRelabels += o.globalRelabels;
+        orphans += o.orphans;
+        adoptions += o.adoptions;
+        bellmanFordRounds += o.bellmanFordRounds;
+        allocations += o.allocations;
+        heapAllocations += o.heapAllocations;
+        parseSeconds += o.parseSeconds;
+        buildSeconds += o.buildSeconds;
+        solveSeconds += o.solveSeconds;
+        outputSeconds += o.outputSeconds;
+        return *this;
+    }
+};
+
+// Splits a run into stages: each lap() returns the seconds since the
+// previous one (or since construction).
+class StageTimer
+{
+public:
+    StageTimer() : last(chrono::steady_clock::now()) {}
+
+    double lap()
+    {
+        auto now = chrono::steady_clock::now();
+        double seconds = chrono::duration<double>(now - last).count();
+        last = now;
+        return seconds;
+    }
+
+private:
+    chrono::steady_clock::time_point last;
+};
+
+#endif // SOLVER_STATS_H
@@ -0,0 +1,80 @@
+#include "solvers.h"
+#include "dinic.h"
+#include "edmonds_karp.h"
+#include "goldberg_tarjan.h"
+#include "mcmf.h"
+#include "cost_scaling.h"
+#include "boykov_kolmogorov.h"
+#include "min_cut_algorithms.h"
+#include "parallel_push_relabel.h"
+#include "work_stealing.h"
+#include "workspace.h"
+using namespace std;
+
+const vector<string> &algorithmNames()
+{
+    static const vector<string> names = {
+        "dinic", "dinic32", "dinic_double", "dinic_reverse", "edmonds_karp",
+        "edmonds_karp_scaling", "edmonds_karp_bidirectional", "goldberg_tarjan",
+        "goldberg_tarjan_fifo", "goldberg_tarjan_cut", "push_relabel_parallel", "mcmf",
+        "mcmf_cost_scaling", "bk"};
+    return names;
+}
+
+static bool dispatch(const string &algo, const Graph &graph, ResultWriter &out)
+{
+    if (algo == "dinic")
+        runDinic(graph, out);
+    else if (algo == "dinic32")
+        runDinic<int>(graph, out);
+    else if (algo == "dinic_double")
+        runDinic<double>(graph, out);
+    else if (algo == "dinic_reverse")
+        runDinic(graph, out, DinicLabels::Reverse);
+    else if (algo == "edmonds_karp")
+        runEdmondsKarp(graph, out);
+    else if (algo == "edmonds_karp_scaling")
+        runEdmondsKarp(graph, out, true);
+    else if (algo == "edmonds_karp_bidirectional")
+        runEdmondsKarp(graph, out, false, true);
+    else if (algo == "goldberg_tarjan")
+        runGoldbergTarjan(graph, out);
+    else if (algo == "goldberg_tarjan_fifo")
+        runGoldbergTarjan(graph, out, PushRelabelOrder::FIFO);
+    else if (algo == "goldberg_tarjan_cut")
+    {
+        // Only for this run: --serve reuses the writer for later jobs.
+        bool cutOnly = out.cutOnly;
+        out.cutOnly = true;
+        runGoldbergTarjan(graph, out);
+        out.cutOnly = cutOnly;
+    }
+    else if (algo == "push_relabel_parallel")
+        runParallelPushRelabel(graph, out, defaultThreadCount());
+    else if (algo == "mcmf")
+        runMCMF(graph, out);
+    else if (algo == "mcmf_cost_scaling")
+        runCostScaling(graph, out);
+    else if (algo == "bk")
+        runBoykovKolmogorov(graph, out);
+    else if (algo == "gomory_hu")
+        runGomoryHu(graph, out);
+    else
+        return false;
+    return true;
+}
+
+// Runs the named solver, which streams its result through out.
+// Returns false if the algorithm is unknown.
+bool runAlgorithm(const string &algo, const Graph &graph, ResultWriter &out)
+{
+    // Working memory comes from a per-thread arena that keeps its blocks
+    // between runs, so repeated solves (--serve, batches) stop allocating
+    // once the largest graph has been seen.
+    static thread_local Workspace workspace;
+    workspace.reset();
+    out.workspace = &workspace;
+    bool known = dispatch(algo, graph, out);
+    out.workspace = nullptr;
+    return known;
+}
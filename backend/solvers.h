@@ -0,0 +1,19 @@
+#ifndef SOLVERS_H
+#define SOLVERS_H
+
+#include "graph.h"
+#include "result_writer.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+// The src-sink max-flow solvers accepted by runAlgorithm, in the order
+// flow_bench runs them. runAlgorithm also accepts "gomory_hu", which reports
+// a cut tree rather than one max flow.
+const vector<string> &algorithmNames();
+
+// Runs the named solver, which streams its result through out.
+// Returns false if the algorithm is unknown.
+bool runAlgorithm(const string &algo, const Graph &graph, ResultWriter &out);
+
+#endif // SOLVERS_H
@@ -0,0 +1,29 @@
+#ifndef VERTEX_ORDER_H
+#define VERTEX_ORDER_H
+
+#include "graph.h"
+#include <string>
+#include <vector>
+using namespace std;
+
+// Node numberings that place nodes touched together close in memory, so the
+// residual graph's per-node arrays and arc ranges are walked with fewer
+// cache misses.
+enum class VertexOrder
+{
+    BFS,    // breadth-first from src, then any unreached nodes
+    RCM,    // reverse Cuthill-McKee: small bandwidth on mesh-like graphs
+    Degree  // highest degree first, so hub data shares cache lines
+};
+
+// Parses "bfs", "rcm" or "degree".
+bool parseVertexOrder(const string &name, VertexOrder &order);
+
+// New id of every node under the given order. Edge directions are ignored.
+vector<int> vertexOrder(const Graph &graph, VertexOrder order);
+
+// Copy of graph with node v renamed to newId[v]. Edges keep their input
+// order (and costs), so edge indices mean the same in both graphs.
+Graph relabel(const Graph &graph, const vector<int> &newId);
+
+#endif // VERTEX_ORDER_H
@@ -0,0 +1,84 @@
+#include "work_stealing.h"
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Remaining indices [lo, hi) of one worker. The owner takes from the front,
+// thieves from the back.
+struct WorkSlice
+{
+    mutex m;
+    size_t lo = 0, hi = 0;
+};
+
+int defaultThreadCount()
+{
+    const char *env = getenv("FLOW_SOLVER_THREADS");
+    if (env && atoi(env) > 0)
+        return atoi(env);
+    return max(1, (int)thread::hardware_concurrency());
+}
+
+static bool takeOwn(WorkSlice &slice, size_t &i)
+{
+    lock_guard<mutex> lock(slice.m);
+    if (slice.lo == slice.hi)
+        return false;
+    i = slice.lo++;
+    return true;
+}
+
+static bool steal(vector<WorkSlice> &slices, int self)
+{
+    int workers = (int)slices.size();
+    for (int k = 1; k < workers; k++)
+    {
+        WorkSlice &victim = slices[(self + k) % workers];
+        size_t lo, hi;
+        {
+            lock_guard<mutex> lock(victim.m);
+            size_t left = victim.hi - victim.lo;
+            if (left == 0)
+                continue;
+            hi = victim.hi;
+            lo = hi - (left + 1) / 2;
+            victim.hi = lo;
+        }
+        lock_guard<mutex> lock(slices[self].m);
+        slices[self].lo = lo;
+        slices[self].hi = hi;
+        return true;
+    }
+    return false;
+}
+
+void parallelFor(size_t count, int threads, const function<void(int, size_t)> &body)
+{
+    int workers = (int)max<size_t>(1, min<size_t>(max(threads, 1), count));
+    vector<WorkSlice> slices(workers);
+    for (int w = 0; w < workers; w++)
+    {
+        slices[w].lo = count * w / workers;
+        slices[w].hi = count * (w + 1) / workers;
+    }
+    // Tasks never spawn tasks, so a worker that finds every slice empty is done.
+    auto run = [&](int w) {
+        size_t i;
+        while (true)
+        {
+            if (takeOwn(slices[w], i))
+                body(w, i);
+            else if (!steal(slices, w))
+                break;
+        }
+    };
+    vector<thread> pool;
+    for (int w = 1; w < workers; w++)
+        pool.emplace_back(run, w);
+    run(0);
+    for (thread &th : pool)
+        th.join();
+}
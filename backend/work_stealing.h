@@ -0,0 +1,18 @@
+#ifndef WORK_STEALING_H
+#define WORK_STEALING_H
+
+#include <cstddef>
+#include <functional>
+using namespace std;
+
+// Default worker count: $FLOW_SOLVER_THREADS if set, else the hardware
+// thread count.
+int defaultThreadCount();
+
+// Calls body(worker, i) for every i in [0, count) on up to `threads` workers
+// (the calling thread is worker 0). Each worker starts with a contiguous
+// slice of the indices and, once it runs dry, steals the back half of
+// another worker's remaining slice, so uneven task costs still balance.
+void parallelFor(size_t count, int threads, const function<void(int, size_t)> &body);
+
+#endif // WORK_STEALING_H
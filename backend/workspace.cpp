@@ -0,0 +1,63 @@
+#include "workspace.h"
+#include <algorithm>
+using namespace std;
+
+// Smallest block taken from the heap.
+static const size_t MIN_BLOCK = 64 << 10;
+
+Workspace::~Workspace()
+{
+    release();
+}
+
+void Workspace::release()
+{
+    for (const Block &b : blocks)
+        ::operator delete(b.data);
+    blocks.clear();
+    used = 0;
+}
+
+void Workspace::reset()
+{
+    if (blocks.size() > 1)
+    {
+        size_t total = 0;
+        for (const Block &b : blocks)
+            total += b.size;
+        release();
+        blocks.push_back({(char *)::operator new(total), total});
+    }
+    used = 0;
+    served = fetched = 0;
+}
+
+void *Workspace::do_allocate(size_t bytes, size_t alignment)
+{
+    served++;
+    if (!blocks.empty())
+    {
+        const Block &b = blocks.back();
+        size_t at = (used + alignment - 1) / alignment * alignment;
+        if (at + bytes <= b.size)
+        {
+            used = at + bytes;
+            return b.data + at;
+        }
+    }
+    // Blocks at least double, so a run needs O(log size) of them. operator
+    // new aligns to max_align_t, enough for everything the solvers store.
+    size_t size = max({MIN_BLOCK, bytes, blocks.empty() ? 0 : 2 * blocks.back().size});
+    blocks.push_back({(char *)::operator new(size), size});
+    fetched++;
+    used = bytes;
+    return blocks.back().data;
+}
+
+/*
+TC Analysis:
+  - O(1) per allocation; reset() is O(blocks).
+SC Analysis:
+  - The largest run's working memory, plus the old buffers of vectors that
+    grew during it: deallocation is a no-op until reset().
+*/
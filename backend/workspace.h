@@ -0,0 +1,52 @@
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+using namespace std;
+
+// Monotonic arena for solver working memory. Allocation bumps a pointer and
+// freeing is a no-op; reset() rewinds the arena for the next run but keeps
+// its memory, so once a workspace has seen a graph of a given size, solving
+// graphs up to that size again takes no heap allocations. Not thread-safe:
+// each thread uses its own workspace.
+class Workspace : public pmr::memory_resource
+{
+public:
+    Workspace() = default;
+    Workspace(const Workspace &) = delete;
+    Workspace &operator=(const Workspace &) = delete;
+    ~Workspace();
+
+    // Every container allocated from the arena must be gone by now. If the
+    // last run needed several blocks, they are merged into one.
+    void reset();
+
+    // Since the last reset: allocations served, and how many of them needed
+    // a new block from the heap.
+    long long allocations() const { return served; }
+    long long heapAllocations() const { return fetched; }
+
+protected:
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *, size_t, size_t) override {}
+    bool do_is_equal(const pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    struct Block
+    {
+        char *data;
+        size_t size;
+    };
+    vector<Block> blocks; // the last one is being filled
+    size_t used = 0;      // bytes taken from the last block
+    long long served = 0, fetched = 0;
+
+    void release();
+};
+
+#endif // WORKSPACE_H
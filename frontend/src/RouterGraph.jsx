@@ -108,7 +108,9 @@ function RouterGraph() {
         try {
           const outputData = JSON.parse(res.data.output);
           setSimOutput(JSON.stringify(outputData, null, 2));
-          const updatedEdges = edges.map(edge => {
+          // Cut edges are reported by input index, which follows edges' order.
+          const cutEdges = new Set(outputData.cutEdges || []);
+          const updatedEdges = edges.map((edge, i) => {
             const edgeData = outputData.edgeFlows.find(ef =>
               parseInt(edge.source.split('-')[1], 10) === ef.u &&
               parseInt(edge.target.split('-')[1], 10) === ef.v
@@ -116,7 +118,7 @@ function RouterGraph() {
             if (edgeData) {
               const ratio = edgeData.cap > 0 ? edgeData.flow / edgeData.cap : 0;
               const strokeWidth = 2 + ratio * 8;
-              const strokeColor = ratio > 0.5 ? '#2ecc71' : '#3498db';
+              const strokeColor = cutEdges.has(i) ? '#e74c3c' : ratio > 0.5 ? '#2ecc71' : '#3498db';
               return {
                 ...edge,
                 label: `${edgeData.flow}/${edgeData.cap}`,
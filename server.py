@@ -1,34 +1,98 @@
 from flask import Flask, request, jsonify
 from flask_cors import CORS
 import subprocess
+import threading
+import queue
 import os
 
 app = Flask(__name__)
 CORS(app)
 
+EXE_PATH = os.path.join('backend', 'flow_solver.exe')
+POOL_SIZE = int(os.environ.get('FLOW_SOLVER_WORKERS', os.cpu_count() or 1))
+# Seconds a job may take before its worker is killed and replaced.
+JOB_TIMEOUT = float(os.environ.get('FLOW_SOLVER_TIMEOUT', 60))
+
+
+class SolverWorker:
+    """One warm `flow_solver --serve` process; handles one job at a time."""
+
+    def __init__(self):
+        self.proc = None
+        self.lines = None
+
+    def _start(self):
+        self.proc = subprocess.Popen(
+            [EXE_PATH, '--serve'],
+            stdin=subprocess.PIPE,
+            stdout=subprocess.PIPE,
+            stderr=subprocess.DEVNULL
+        )
+        # Pipes cannot be read with a timeout portably, so a thread hands
+        # each output line over through a queue; b'' marks the end.
+        self.lines = queue.Queue()
+        threading.Thread(target=self._read, args=(self.proc.stdout, self.lines), daemon=True).start()
+
+    @staticmethod
+    def _read(stdout, lines):
+        for line in iter(stdout.readline, b''):
+            lines.put(line)
+        lines.put(b'')
+
+    def _stop(self):
+        if self.proc is not None:
+            self.proc.kill()
+            self.proc.wait()
+        self.proc = None
+
+    def run(self, algo, input_text):
+        if self.proc is None or self.proc.poll() is not None:
+            self._start()
+        payload = input_text.encode()
+        header = '{} {}\n'.format(algo, len(payload)).encode()
+        try:
+            self.proc.stdin.write(header + payload)
+            self.proc.stdin.flush()
+            line = self.lines.get(timeout=JOB_TIMEOUT)
+        except queue.Empty:
+            # A stuck job would block every later one on this worker.
+            self._stop()
+            raise RuntimeError('flow_solver timed out after {:g} s'.format(JOB_TIMEOUT))
+        except OSError:
+            line = b''
+        if not line:
+            # The worker died mid-job; restart it for the next request.
+            self._stop()
+            raise RuntimeError('flow_solver exited unexpectedly')
+        return line.decode().rstrip('\n')
+
+
+# Workers are checked out per request, so concurrent requests never share a
+# process and no temporary input file is needed.
+workers = queue.Queue()
+for _ in range(POOL_SIZE):
+    workers.put(SolverWorker())
+
+
 @app.route('/run-algo', methods=['POST'])
 def run_algo():
     data = request.get_json()
     algo = data.get('algo', 'dinic')
     input_text = data.get('input', '')
-    
-    with open('input.txt', 'w') as f:
-        f.write(input_text)
-    
-    exe_path = os.path.join('backend', 'flow_solver.exe')
+
+    # The algorithm name goes into the job header, so it must be one token.
+    if not algo or any(c.isspace() for c in algo):
+        return jsonify({'output': 'Unknown algorithm: ' + algo})
+
+    worker = workers.get()
     try:
-        result = subprocess.run(
-            [exe_path, algo],
-            stdin=open('input.txt', 'r'),
-            stdout=subprocess.PIPE,
-            stderr=subprocess.PIPE,
-            text=True
-        )
-        output = result.stdout
+        output = worker.run(algo, input_text)
     except Exception as e:
         output = str(e)
-    
+    finally:
+        workers.put(worker)
+
     return jsonify({'output': output})
 
 if __name__ == '__main__':
-    app.run(port=5000)
+    app.run(port=5000, threaded=True)